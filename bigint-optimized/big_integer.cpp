@@ -1,10 +1,27 @@
 #include "big_integer.h"
+#include "big_integer_expr.h"
+#include "limb_ops.h"
+#include "limb_memory.h"
 
 #include <string>
 #include <stdexcept>
 #include <algorithm>
 #include <tuple>
 #include <cmath>
+#include <vector>
+
+#if defined(__GNUC__)
+static_assert(sizeof(big_integer) == sizeof(my_vector), "sign is expected in the tail padding of data");
+#endif
+
+namespace {
+    // decimal digits per limb-sized chunk in radix conversion, and 10 to that power
+    const size_t CHUNK_DIGITS = LIMB_BITS == 64 ? 19 : 9;
+    const limb_t CHUNK = LIMB_BITS == 64 ? static_cast<limb_t>(10000000000000000000ull) : 1000000000;
+
+    // numbers up to this many limbs are converted chunk by chunk, larger ones split in half recursively
+    const size_t DECIMAL_SPLIT_THRESHOLD = 64;
+}
 
 
 big_integer::big_integer() : data(), sign(false) {
@@ -12,21 +29,22 @@ big_integer::big_integer() : data(), sign(false) {
 
 big_integer::big_integer(big_integer const &other) = default;
 
+big_integer::big_integer(big_integer &&other) noexcept : data(std::move(other.data)), sign(other.sign) {
+    other.sign = false;
+}
+
 big_integer::big_integer(int a) : data(1), sign(a < 0) {
-    data[0] = static_cast<uint32_t>(a);
+    data[0] = static_cast<limb_t>(a);
     shrink_to_fit();
 }
 
 
 big_integer::big_integer(const std::string &s) : big_integer() {
-
-    for (size_t i = 0; i < s.size(); i++) {
-        if ((s[i] == '+' || s[i] == '-') && i == 0) continue;
-        if (s[i] < '0' || '9' < s[i]) {
-            throw std::runtime_error("invalid string");
-        }
-        (*this) = (*this).mul_by_uint32_t(10) + static_cast<uint32_t>(s[i] - '0');
+    size_t start = !s.empty() && (s[0] == '+' || s[0] == '-') ? 1 : 0;
+    if (!limb_ops::is_decimal(s.data() + start, s.size() - start)) {
+        throw std::runtime_error("invalid string");
     }
+    (*this) = from_decimal(s.data() + start, s.size() - start);
     if (!s.empty() && s[0] == '-') {
         (*this) = -(*this);
     }
@@ -37,38 +55,58 @@ big_integer::~big_integer() = default;
 
 big_integer &big_integer::operator=(big_integer const &other) = default;
 
+big_integer &big_integer::operator=(big_integer &&other) noexcept {
+    if (this != &other) {
+        data = std::move(other.data);
+        sign = other.sign;
+        other.sign = false;
+    }
+    return *this;
+}
+
 
+// Additions and subtractions leave their result unnormalized: the width only
+// grows when the limb above both operands is not a plain sign extension, and
+// redundant top limbs are dropped by whoever needs the minimal length.
 big_integer &big_integer::operator+=(big_integer const &rhs) {
-    data.resize(std::max(data.size(), rhs.data.size()) + 1, empty_block());
-    uint64_t carry = 0;
-    for (size_t i = 0; i < data.size(); i++) {
-        carry = carry + data[i] + (i < rhs.data.size() ? rhs.data[i] : rhs.empty_block());
-        data[i] = static_cast<uint32_t>(carry);
-        carry >>= BIT_DEPTH;
-    }
-    set_sign();
-    shrink_to_fit();
+    size_t n = rhs.data.size();
+    limb_t block = empty_block(), rhs_block = rhs.empty_block();
+    if (n > data.size()) {
+        data.resize(n, block);
+    }
+    limb_t *d = data.mutable_data();
+    limb_t carry = limb_ops::add_n(d, d, rhs.data.data(), n);
+    // past rhs the limbs only change while the carry differs from what the sign of rhs cancels
+    for (size_t i = n; i < data.size() && carry != (rhs_block & 1); i++) {
+        d[i] = add_with_carry(d[i], rhs_block, carry);
+    }
+    extend(add_with_carry(block, rhs_block, carry));
     return *this;
 }
 
 big_integer &big_integer::operator-=(big_integer const &rhs) {
-    return (*this) += (-rhs);
+    size_t n = rhs.data.size();
+    limb_t block = empty_block(), rhs_block = rhs.empty_block();
+    if (n > data.size()) {
+        data.resize(n, block);
+    }
+    limb_t *d = data.mutable_data();
+    limb_t borrow = limb_ops::sub_n(d, d, rhs.data.data(), n);
+    for (size_t i = n; i < data.size() && borrow != (rhs_block & 1); i++) {
+        d[i] = sub_with_borrow(d[i], rhs_block, borrow);
+    }
+    extend(sub_with_borrow(block, rhs_block, borrow));
+    return *this;
 }
 
-big_integer square_mul(big_integer const &left, big_integer const &right) {
+big_integer schoolbook_mul(big_integer const &left, big_integer const &right) {
+    // one multiply-accumulate row per limb of the shorter operand, straight into the result
+    big_integer const &longer = left.data.size() >= right.data.size() ? left : right;
+    big_integer const &shorter = left.data.size() >= right.data.size() ? right : left;
     big_integer result;
     result.data.resize(left.data.size() + right.data.size(), 0);
-    big_integer temp;
-    uint64_t carry = 0;
-    for (size_t i = 0; i < right.data.size(); i++) {
-        temp = left.mul_by_uint32_t(right.data[i]);
-        for (size_t j = 0; j + i < result.data.size(); j++) {
-            if (carry == 0 && j >= temp.data.size()) break;
-            carry = carry + static_cast<uint64_t>(result.data[i + j]) + (j < temp.data.size() ? temp.data[j] : 0);
-            result.data[i + j] = static_cast<uint32_t>(carry);
-            carry >>= big_integer::BIT_DEPTH;
-        }
-    }
+    limb_ops::mul_basecase(result.data.mutable_data(), longer.data.data(), longer.data.size(),
+                           shorter.data.data(), shorter.data.size());
     result.shrink_to_fit();
     return result;
 }
@@ -79,153 +117,406 @@ big_integer copy(big_integer const &left, size_t l, size_t r) {
     }
     big_integer temp;
     temp.data.resize(r - l, 0);
-    for (size_t i = l; i < r; i++) {
-        temp.data[i - l] = left.data[i];
-    }
+    std::copy(left.data.data() + l, left.data.data() + r, temp.data.mutable_data());
+    temp.shrink_to_fit();
     return temp;
 }
 
 
 big_integer big_integer::Karatsuba_mul(big_integer const &left, big_integer const &right) {
-    if (left.data.empty() || right.data.empty()) {
-        return 0;
+    size_t n = std::max(left.data.size(), right.data.size());
+    // the shorter operand padded to n limbs, then the recursion scratch
+    std::pmr::vector<limb_t> buffer(n + limb_ops::karatsuba_scratch(n), 0, limb_memory::resource());
+    auto padded = [&buffer, n](big_integer const &x) -> limb_t const * {
+        if (x.data.size() == n) {
+            return x.data.data();
+        }
+        std::copy(x.data.data(), x.data.data() + x.data.size(), buffer.data());
+        return buffer.data();
+    };
+    limb_t const *a = padded(left), *b = padded(right);
+
+    big_integer result;
+    result.data.resize(2 * n, 0);
+    limb_ops::karatsuba(result.data.mutable_data(), a, b, n, buffer.data() + n);
+    result.shrink_to_fit();
+    return result;
+}
+
+big_integer big_integer::Ntt_mul(big_integer const &left, big_integer const &right) {
+    size_t n = left.data.size(), m = right.data.size();
+    big_integer result;
+    result.data.resize(n + m, 0);
+    limb_ops::ntt_mul(result.data.mutable_data(), left.data.data(), n, right.data.data(), m);
+    result.shrink_to_fit();
+    return result;
+}
+
+big_integer big_integer::signed_mul(big_integer const &left, big_integer const &right) {
+    if (&left == &right) {
+        return square_dispatch(abs(left));
+    }
+    big_integer result = mul_dispatch(abs(left), abs(right));
+    return left.sign ^ right.sign ? -result : result;
+}
+
+// Toom-3 with Bodrato's evaluation points 0, 1, -1, -2, inf; squares when both
+// operands are the same object, since then all five point products are squares
+big_integer big_integer::Toom3_mul(big_integer const &left, big_integer const &right) {
+    bool squaring = &left == &right;
+    size_t k = (std::max(left.data.size(), right.data.size()) + 2) / 3;
+    big_integer a0 = copy(left, 0, std::min(k, left.data.size()));
+    big_integer a1 = copy(left, k, std::min(2 * k, left.data.size()));
+    big_integer a2 = copy(left, 2 * k, left.data.size());
+    big_integer b0 = copy(right, 0, std::min(k, right.data.size()));
+    big_integer b1 = copy(right, k, std::min(2 * k, right.data.size()));
+    big_integer b2 = copy(right, 2 * k, right.data.size());
+
+    big_integer a02 = a0 + a2, b02 = b0 + b2;
+    big_integer a_m1 = a02 - a1, b_m1 = b02 - b1;
+    big_integer a_m2 = ((a_m1 + a2) << 1) - a0, b_m2 = ((b_m1 + b2) << 1) - b0;
+
+    big_integer a_1 = a02 + a1, b_1 = b02 + b1;
+    big_integer r0 = mul_dispatch(a0, squaring ? a0 : b0);
+    big_integer r1 = mul_dispatch(a_1, squaring ? a_1 : b_1);
+    big_integer r_m1 = signed_mul(a_m1, squaring ? a_m1 : b_m1);
+    big_integer r_m2 = signed_mul(a_m2, squaring ? a_m2 : b_m2);
+    big_integer r_inf = mul_dispatch(a2, squaring ? a2 : b2);
+
+    big_integer r3 = (r_m2 - r1) / 3;
+    r1 = (r1 - r_m1) >> 1;
+    big_integer r2 = r_m1 - r0;
+    r3 = ((r2 - r3) >> 1) + (r_inf << 1);
+    r2 += r1 - r_inf;
+    r1 -= r3;
+
+    int shift = static_cast<int>(LIMB_BITS * k);
+    return (lazy(r_inf) << (4 * shift)) + (lazy(r3) << (3 * shift)) + (lazy(r2) << (2 * shift)) + (lazy(r1) << shift) + r0;
+}
+
+// multiplies operands of very different lengths by slicing the longer one
+big_integer big_integer::unbalanced_mul(big_integer const &left, big_integer const &right) {
+    big_integer const &longer = left.data.size() >= right.data.size() ? left : right;
+    big_integer const &shorter = left.data.size() >= right.data.size() ? right : left;
+    size_t step = shorter.data.size();
+    big_integer result;
+    for (size_t l = 0; l < longer.data.size(); l += step) {
+        big_integer part = mul_dispatch(copy(longer, l, std::min(l + step, longer.data.size())), shorter);
+        result.add_shifted(part, static_cast<int>(LIMB_BITS * l));
+    }
+    return result;
+}
+
+big_integer big_integer::square_dispatch(big_integer const &x) {
+    size_t n = x.data.size();
+    if (n >= limb_ops::NTT_THRESHOLD && limb_ops::ntt_fits(n, n)) {
+        return Ntt_mul(x, x);
     }
-    if (left.data.size() == 1) {
-        return right.mul_by_uint32_t(left.data.back());
+    if (n >= limb_ops::TOOM3_THRESHOLD) {
+        return Toom3_mul(x, x);
     }
-    if (right.data.size() == 1) {
-        return left.mul_by_uint32_t(right.data.back());
+    std::pmr::vector<limb_t> scratch(limb_ops::karatsuba_scratch(n), limb_memory::resource());
+    big_integer result;
+    result.data.resize(2 * n, 0);
+    limb_ops::karatsuba_sqr(result.data.mutable_data(), x.data.data(), n, scratch.data());
+    result.shrink_to_fit();
+    return result;
+}
+
+big_integer big_integer::mul_dispatch(big_integer const &left, big_integer const &right) {
+    if (&left == &right) {
+        return square_dispatch(left);
     }
-    if (left.data.size()  < 16 ||  right.data.size() < 16) {
-        return square_mul(left, right);
+    size_t n = std::min(left.data.size(), right.data.size());
+    size_t m = std::max(left.data.size(), right.data.size());
+    if (n == 0) {
+        return 0;
     }
-    size_t n = std::max(left.data.size(), right.data.size());
-    size_t ndiv2 = n / 2;
-    big_integer left_l = copy(left, ndiv2, left.data.size());
-    big_integer left_r = copy(left, 0, std::min(ndiv2, left.data.size()));
-    big_integer right_l = copy(right, ndiv2, right.data.size());
-    big_integer right_r = copy(right, 0, std::min(ndiv2, right.data.size()));
+    if (n < limb_ops::KARATSUBA_THRESHOLD) {
+        return schoolbook_mul(left, right);
+    }
+    if (n >= limb_ops::NTT_THRESHOLD && limb_ops::ntt_fits(n, m)) {
+        return Ntt_mul(left, right);
+    }
+    if (2 * n <= m) {
+        return unbalanced_mul(left, right);
+    }
+    if (n < limb_ops::TOOM3_THRESHOLD) {
+        return Karatsuba_mul(left, right);
+    }
+    return Toom3_mul(left, right);
+}
+
+// *this += (subtract ? -1 : 1) * a * b. Unless both factors are long enough for
+// Karatsuba, each limb of the shorter factor becomes one multiply-accumulate row
+// straight into the limbs of *this, with the carry or borrow run up to the top
+big_integer &big_integer::accumulate_product(big_integer const &a, big_integer const &b, bool subtract) {
+    bool negative = subtract ^ a.sign ^ b.sign;
+    if (std::min(a.data.size(), b.data.size()) >= limb_ops::KARATSUBA_THRESHOLD) {
+        // Deliberately not in place: a subquadratic product needs its own buffer
+        // anyway, and one more pass to add it is cheap next to computing it
+        big_integer a_abs = abs(a);
+        big_integer product = mul_dispatch(a_abs, &a == &b ? a_abs : abs(b));
+        return negative ? *this -= product : *this += product;
+    }
+
+    // A positive factor is read where it is. A negative one is negated into
+    // scratch, and so is a factor aliasing *this, which is overwritten below.
+    auto in_scratch = [this](big_integer const &x) {
+        return x.sign || &x == this;
+    };
+    size_t scratch_size = (in_scratch(a) ? a.data.size() + 1 : 0) +
+                          (in_scratch(b) && &a != &b ? b.data.size() + 1 : 0);
+    std::pmr::vector<limb_t> scratch(scratch_size, limb_memory::resource());
+    limb_t *next = scratch.data();
+    auto magnitude = [&](big_integer const &x, size_t &size) -> limb_t const * {
+        limb_t const *p = x.data.data();
+        size = x.data.size();
+        if (in_scratch(x)) {
+            if (x.sign) {
+                limb_t one = 1;
+                std::transform(p, p + size, next, [](limb_t v) { return ~v; });
+                next[size] = 0;
+                limb_ops::add_in_place(next, ++size, &one, 1);
+            } else {
+                std::copy(p, p + size, next);
+            }
+            p = next;
+            next += size;
+        }
+        while (size > 0 && p[size - 1] == 0) {
+            size--;
+        }
+        return p;
+    };
+    size_t a_size, b_size;
+    limb_t const *a_limbs = magnitude(a, a_size), *b_limbs = a_limbs;
+    b_size = a_size;
+    if (&a != &b) {
+        b_limbs = magnitude(b, b_size);
+    }
+    bool a_longer = a_size >= b_size;
+    limb_t const *longer = a_longer ? a_limbs : b_limbs, *shorter = a_longer ? b_limbs : a_limbs;
+    size_t n = std::max(a_size, b_size), m = std::min(a_size, b_size);
+
+    size_t width = std::max(data.size(), n + m) + 1;
+    data.resize(width, empty_block());
+    limb_t *d = data.mutable_data();
+    for (size_t i = 0; i < m; i++) {
+        limb_t high = negative ? limb_ops::submul_1(d + i, longer, n, shorter[i])
+                               : limb_ops::addmul_1(d + i, longer, n, shorter[i]);
+        if (negative) {
+            limb_ops::sub_in_place(d + i + n, width - i - n, &high, 1);
+        } else {
+            limb_ops::add_in_place(d + i + n, width - i - n, &high, 1);
+        }
+    }
+    set_sign();
+    shrink_to_fit();
+    return *this;
+}
+
+big_integer &big_integer::addmul(big_integer const &a, big_integer const &b) {
+    return accumulate_product(a, b, false);
+}
 
-    big_integer product_1 = Karatsuba_mul(left_l, right_l);
-    big_integer product_2 = Karatsuba_mul(left_r, right_r);
-    big_integer product_3 = Karatsuba_mul(left_l + left_r, right_l + right_r);
+big_integer &big_integer::submul(big_integer const &a, big_integer const &b) {
+    return accumulate_product(a, b, true);
+}
+
+big_integer &big_integer::addmul_ui(big_integer const &a, uint32_t b) {
+    big_integer multiplier;
+    multiplier.data.resize(1, b);
+    multiplier.shrink_to_fit();
+    return accumulate_product(a, multiplier, false);
+}
 
-    return (product_1 << (BIT_DEPTH * 2 * ndiv2)) + ((product_3 - product_1 - product_2) << (BIT_DEPTH * ndiv2)) + product_2;
+big_integer &big_integer::add_shifted(big_integer const &b, int shift) {
+    if (&b == this) {
+        return add_shifted(big_integer(b), shift);
+    }
+    size_t width = std::max(data.size(), b.data.size() + (shift + LIMB_BITS - 1) / LIMB_BITS) + 1;
+    data.resize(width, empty_block());
+    add_shifted_limbs(data.mutable_data(), width, b, shift, false);
+    set_sign();
+    shrink_to_fit();
+    return *this;
 }
 
+big_integer big_integer::square() const {
+    return square_dispatch(abs(*this));
+}
 
 big_integer &big_integer::operator*=(big_integer const &rhs) {
     big_integer left = abs(*this);
     big_integer right = abs(rhs);
     big_integer &result = *this;
     bool result_sign = sign ^ rhs.sign;
-    result = square_mul(left, right);
+    result = mul_dispatch(left, this == &rhs ? left : right);
     if (result_sign) {
         result = -result;
     }
     return result;
 }
 
-big_integer &big_integer::operator/=(big_integer const &rhs) {
-    if (rhs == 0) {
+// quotient and remainder of a >= 0 by b > 0 by schoolbook long division
+std::pair<big_integer, big_integer> big_integer::divrem_basecase(big_integer const &a, big_integer const &b) {
+    if (a < b) {
+        return std::make_pair(big_integer(), a);
+    }
+    size_t n = b.data.size(), m = a.data.size();
+    big_integer quotient, remainder;
+    if (n == 1) {
+        std::pair<big_integer, limb_t> qr = a.div_by_limb(b.data[0]);
+        remainder.data.resize(1, qr.second);
+        remainder.shrink_to_fit();
+        return std::make_pair(qr.first, remainder);
+    }
+    std::pmr::vector<limb_t> scratch(m + n + 1, limb_memory::resource());
+    quotient.data.resize(m - n + 1, 0);
+    remainder.data.resize(n, 0);
+    limb_ops::divrem(quotient.data.mutable_data(), remainder.data.mutable_data(),
+                     a.data.data(), m, b.data.data(), n, scratch.data());
+    quotient.shrink_to_fit();
+    remainder.shrink_to_fit();
+    return std::make_pair(quotient, remainder);
+}
+
+// Burnikel-Ziegler recursive division. b has n limbs with the top bit set,
+// 0 <= a < b * B^m (B being the limb base) and m <= n. The top half of the
+// quotient comes from dividing the top limbs of a by the top limbs of b, the
+// bottom half from the same step applied to the remainder.
+std::pair<big_integer, big_integer> big_integer::divrem_recursive(big_integer const &a, big_integer const &b, size_t m) {
+    if (m < std::max<size_t>(limb_ops::BURNIKEL_ZIEGLER_THRESHOLD, 2)) {
+        return divrem_basecase(a, b);
+    }
+    size_t k = m / 2;
+    int shift = static_cast<int>(LIMB_BITS * k);
+    big_integer b1 = b >> shift, b0 = copy(b, 0, k);
+
+    std::pair<big_integer, big_integer> high = divrem_recursive(a >> (2 * shift), b1, m - k);
+    big_integer remainder = (lazy(high.second) << (2 * shift)) + copy(a, 0, std::min(2 * k, a.data.size()))
+                            - (lazy(mul_dispatch(high.first, b0)) << shift);
+    while (remainder < 0) {
+        --high.first;
+        remainder += b << shift;
+    }
+
+    std::pair<big_integer, big_integer> low = divrem_recursive(remainder >> shift, b1, k);
+    remainder = (lazy(low.second) << shift) + copy(remainder, 0, std::min(k, remainder.data.size()))
+                - mul_dispatch(low.first, b0);
+    while (remainder < 0) {
+        --low.first;
+        remainder += b;
+    }
+    return std::make_pair(big_integer((lazy(high.first) << shift) + low.first), remainder);
+}
+
+std::pair<big_integer, big_integer> big_integer::divrem_dispatch(big_integer const &a, big_integer const &b) {
+    size_t n = b.data.size();
+    if (n < limb_ops::BURNIKEL_ZIEGLER_THRESHOLD || a.data.size() < n + limb_ops::BURNIKEL_ZIEGLER_THRESHOLD) {
+        return divrem_basecase(a, b);
+    }
+    int shift = 0;
+    while (!(b.data.back() << shift >> (LIMB_BITS - 1))) {
+        shift++;
+    }
+    return divrem_shifted(a, b << shift, shift);
+}
+
+// a / b and a % b for a >= 0 at least as long as b, with the divisor given as
+// y = b << shift where the top bit of y is set, so callers dividing by one b
+// repeatedly shift it once
+std::pair<big_integer, big_integer> big_integer::divrem_shifted(big_integer const &a, big_integer const &y, int shift) {
+    size_t n = y.data.size();
+    big_integer x = a << shift;
+    x.shrink_to_fit();
+
+    // x < y * B^m holds with one spare limb; peel off n quotient limbs at a time
+    // until the rest is a single recursive 2n by n step
+    size_t m = x.data.size() + 1 - n;
+    big_integer quotient;
+    while (m > n) {
+        int low_bits = static_cast<int>(LIMB_BITS * (m - n));
+        std::pair<big_integer, big_integer> qr = divrem_recursive(x >> low_bits, y, n);
+        quotient = (quotient << static_cast<int>(LIMB_BITS * n)) + qr.first;
+        x = (lazy(qr.second) << low_bits) + copy(x, 0, std::min(m - n, x.data.size()));
+        m -= n;
+    }
+    std::pair<big_integer, big_integer> qr = divrem_recursive(x, y, m);
+    quotient = (quotient << static_cast<int>(LIMB_BITS * m)) + qr.first;
+    return std::make_pair(quotient, qr.second >> shift);
+}
+
+std::pair<big_integer, big_integer> divmod(big_integer const &a, big_integer const &b) {
+    if (b == 0) {
         throw std::runtime_error("division by zero");
     }
-    bool result_sign = sign ^ rhs.sign;
-    big_integer rhs_abs = abs(rhs), &this_abs = *this;
-    this_abs = abs(this_abs);
-    if (rhs_abs > this_abs) {
-        return this_abs = 0;
-    }
-    if (rhs_abs.data.size() == 1) {
-        this_abs = this_abs.div_by_uint32_t(rhs_abs.data.back()).first;
-        if (result_sign) {
-            this_abs = -this_abs;
-        }
-        return this_abs;
+    std::pair<big_integer, big_integer> qr = big_integer::divrem_dispatch(abs(a), abs(b));
+    if (a.sign ^ b.sign) {
+        qr.first = -qr.first;
     }
-
-    size_t n = rhs_abs.data.size(), m = this_abs.data.size();
-    uint64_t f = BASE / static_cast<uint64_t>(rhs_abs.data.back() + 1);
-    big_integer r = this_abs.mul_by_uint32_t(static_cast<uint32_t>(f));
-    big_integer d = rhs_abs.mul_by_uint32_t(static_cast<uint32_t>(f));
-    big_integer result;
-
-    result.data.resize(m - n + 1, empty_block());
-
-    for (ptrdiff_t k = m - n; k >= 0; k--) {
-        r.data.resize(m + n + 1, empty_block());
-        unsigned __int128 dividend = r.data[n + k];
-        dividend <<= BIT_DEPTH;
-        dividend += r.data[n + k - 1];
-        dividend <<= BIT_DEPTH;
-        dividend += r.data[n + k - 2];
-
-        uint64_t divisor = ((static_cast<uint64_t>(1) * d.data[n - 1]) << BIT_DEPTH) + d.data[n - 2];
-        uint32_t qt = dividend / divisor > BASE - 1 ? BASE - 1 : dividend / divisor;
-        big_integer temp = d.mul_by_uint32_t(qt);
-        big_integer dq;
-        dq.data.resize(temp.data.size() + k, 0);
-        for (size_t index = 0; index < temp.data.size(); index++) {
-            dq.data[index + k] = temp.data[index];
-        }
-        if (r < dq) {
-            qt--;
-            dq = (d.mul_by_uint32_t(qt) << (BIT_DEPTH * k));
-        }
-        result.data[k] = static_cast<uint32_t>(qt);
-        r -= dq;
+    if (a.sign) {
+        qr.second = -qr.second;
     }
+    return qr;
+}
 
-
-    if (result_sign) {
-        result = -result;
-    }
-    result.shrink_to_fit();
-    return *this = result;
+big_integer &big_integer::operator/=(big_integer const &rhs) {
+    return *this = divmod(*this, rhs).first;
 }
 
 big_integer &big_integer::operator%=(big_integer const &rhs) {
-    return *this = *this - (*this / rhs) * rhs;
+    return *this = divmod(*this, rhs).second;
 }
 
-big_integer &big_integer::common_fun_bits(big_integer const &rhs, const std::function<uint32_t (uint32_t, uint32_t)> &fn) {
-    data.resize(std::max(data.size(), rhs.data.size()) + 1, empty_block());
-    for (size_t i = 0; i < data.size(); i++) {
-        data[i] = fn(data[i], i < rhs.data.size() ? rhs.data[i] : rhs.empty_block());
+template<typename Op>
+big_integer &big_integer::common_fun_bits(big_integer const &rhs) {
+    size_t n = rhs.data.size();
+    limb_t block = empty_block(), rhs_block = rhs.empty_block();
+    if (n > data.size()) {
+        data.resize(n, block);
     }
-    set_sign();
-    shrink_to_fit();
+    limb_t *d = data.mutable_data();
+    limb_ops::bitwise_n<Op>(d, d, rhs.data.data(), n);
+    Op op;
+    for (size_t i = n; i < data.size(); i++) {
+        d[i] = op(d[i], rhs_block);
+    }
+    // the sign limbs combine into another sign limb, so the width never grows
+    extend(op(block, rhs_block));
     return *this;
 }
 
 big_integer &big_integer::operator&=(big_integer const &rhs) {
-    return common_fun_bits(rhs, [](uint32_t a, uint32_t b) -> uint32_t { return a & b; });
+    return common_fun_bits<limb_ops::bit_and>(rhs);
 }
 
 big_integer &big_integer::operator|=(big_integer const &rhs) {
-    return common_fun_bits(rhs, [](uint32_t a, uint32_t b) -> uint32_t { return a | b; });
+    return common_fun_bits<limb_ops::bit_or>(rhs);
 }
 
 big_integer &big_integer::operator^=(big_integer const &rhs) {
-    return common_fun_bits(rhs, [](uint32_t a, uint32_t b) -> uint32_t { return a ^ b; });
+    return common_fun_bits<limb_ops::bit_xor>(rhs);
 }
 
 big_integer &big_integer::operator<<=(int rhs) {
     if (rhs == 0) {
         return *this;
     }
-    size_t shiftBlocks = rhs / BIT_DEPTH, shiftBits = rhs % BIT_DEPTH;
+    size_t shiftBlocks = rhs / LIMB_BITS, shiftBits = rhs % LIMB_BITS;
     data.resize(data.size() + shiftBlocks + (shiftBits > 0), empty_block());
-    uint32_t current_digit, previous_digit;
+    limb_t *d = data.mutable_data();
+    limb_t current_digit, previous_digit;
     for (ptrdiff_t i = data.size() - 1; i >= 0; --i) {
-        if (static_cast<uint32_t>(i) >= shiftBlocks) {
-            current_digit = data[i - shiftBlocks];
-            previous_digit = static_cast<size_t>(i) >= shiftBlocks + 1 ? data[i - shiftBlocks - 1] : 0;
+        if (static_cast<size_t>(i) >= shiftBlocks) {
+            current_digit = d[i - shiftBlocks];
+            previous_digit = static_cast<size_t>(i) >= shiftBlocks + 1 ? d[i - shiftBlocks - 1] : 0;
         } else {
             current_digit = 0;
             previous_digit = 0;
         }
-        data[i] = (current_digit << shiftBits) + (shiftBits == 0 ? 0 : previous_digit >> (BIT_DEPTH - shiftBits));
+        d[i] = (current_digit << shiftBits) + (shiftBits == 0 ? 0 : previous_digit >> (LIMB_BITS - shiftBits));
     }
     shrink_to_fit();
     return *this;
@@ -235,17 +526,18 @@ big_integer &big_integer::operator>>=(int rhs) {
     if (rhs == 0) {
         return *this;
     }
-    size_t shiftBlocks = rhs / BIT_DEPTH, shiftBits = rhs % BIT_DEPTH;
-    uint32_t current_digit, next_digit;
+    size_t shiftBlocks = rhs / LIMB_BITS, shiftBits = rhs % LIMB_BITS;
+    limb_t *d = data.mutable_data();
+    limb_t current_digit, next_digit;
     for (size_t i = 0; i < data.size(); ++i) {
         if (i + shiftBlocks < data.size()) {
-            current_digit = data[i + shiftBlocks];
-            next_digit = i + shiftBlocks + 1 < data.size() ? data[i + shiftBlocks + 1] : empty_block();
+            current_digit = d[i + shiftBlocks];
+            next_digit = i + shiftBlocks + 1 < data.size() ? d[i + shiftBlocks + 1] : empty_block();
         } else {
             current_digit = empty_block();
             next_digit = empty_block();
         }
-        data[i] = (current_digit >> shiftBits) +  (shiftBits == 0 ? 0 : next_digit << (BIT_DEPTH - shiftBits));
+        d[i] = (current_digit >> shiftBits) +  (shiftBits == 0 ? 0 : next_digit << (LIMB_BITS - shiftBits));
     }
     shrink_to_fit();
     return *this;
@@ -256,14 +548,16 @@ big_integer big_integer::operator+() const {
 }
 
 big_integer big_integer::operator-() const {
-    big_integer r = ~*this + 1;
+    big_integer r;
+    r -= *this;
     return r;
 }
 
 big_integer big_integer::operator~() const {
     big_integer r = *this;
+    limb_t *d = r.data.mutable_data();
     for (size_t i = 0; i < data.size(); i++) {
-        r.data[i] = ~r.data[i];
+        d[i] = ~d[i];
     }
     r.sign = !r.sign;
     r.shrink_to_fit();
@@ -291,53 +585,132 @@ const big_integer big_integer::operator--(int) {
     return r;
 }
 
+// r[0..width) += (negative ? -1 : 1) * (x << shift) in two's complement. The operand
+// is shifted on the fly; a subtraction adds its complement plus one, and the
+// complement of the zero limbs below the shift just carries that one up to limb q
+void big_integer::add_shifted_limbs(limb_t *r, size_t width, big_integer const &x, int shift, bool negative) {
+    limb_t const *d = x.data.data();
+    size_t n = x.data.size(), q = shift / LIMB_BITS;
+    unsigned s = shift % LIMB_BITS;
+    limb_t block = x.empty_block(), mask = negative ? LIMB_MAX : 0;
+    limb_t carry = negative, prev = 0;
+    for (size_t j = q; j < width; j++) {
+        limb_t cur = j - q < n ? d[j - q] : block;
+        limb_t limb = s == 0 ? cur : (cur << s) | (prev >> (LIMB_BITS - s));
+        prev = cur;
+        if (j - q > n && (limb ^ mask) == 0 && carry == 0) {
+            break;
+        }
+        r[j] = add_with_carry(r[j], limb ^ mask, carry);
+    }
+}
+
+big_integer sum_of_terms(shifted_term const *terms, size_t count) {
+    // one limb above the widest shifted operand holds the carries of up to
+    // 2^(LIMB_BITS - 1) terms together with the sign
+    size_t width = 0;
+    for (size_t k = 0; k < count; k++) {
+        size_t limbs = terms[k].value->data.size() + (terms[k].shift + LIMB_BITS - 1) / LIMB_BITS;
+        width = std::max(width, limbs);
+    }
+    width++;
+
+    big_integer result;
+    result.data.resize(width, 0);
+    limb_t *r = result.data.mutable_data();
+    for (size_t k = 0; k < count; k++) {
+        big_integer::add_shifted_limbs(r, width, *terms[k].value, terms[k].shift, terms[k].negative);
+    }
+    result.set_sign();
+    result.shrink_to_fit();
+    return result;
+}
+
 big_integer operator+(big_integer a, big_integer const &b) {
-    return a += b;
+    a += b;
+    return a;
 }
 
 big_integer operator-(big_integer a, big_integer const &b) {
-    return a -= b;
+    a -= b;
+    return a;
+}
+
+// a temporary right operand of a commutative operation takes the result in its own limbs
+big_integer operator+(big_integer const &a, big_integer &&b) {
+    b += a;
+    return std::move(b);
+}
+
+big_integer operator-(big_integer const &a, big_integer &&b) {
+    b -= a;
+    b.negate();
+    return std::move(b);
 }
 
 big_integer operator*(big_integer a, big_integer const &b) {
-    return a *= b;
+    a *= b;
+    return a;
 }
 
 big_integer operator/(big_integer a, big_integer const &b) {
-    return a /= b;
+    a /= b;
+    return a;
 }
 
 big_integer operator%(big_integer a, big_integer const &b) {
-    return a %= b;
+    a %= b;
+    return a;
 }
 
 big_integer operator&(big_integer a, big_integer const &b) {
-    return a &= b;
+    a &= b;
+    return a;
 }
 
 big_integer operator|(big_integer a, big_integer const &b) {
-    return a |= b;
+    a |= b;
+    return a;
 }
 
 big_integer operator^(big_integer a, big_integer const &b) {
-    return a ^= b;
+    a ^= b;
+    return a;
+}
+
+big_integer operator&(big_integer const &a, big_integer &&b) {
+    b &= a;
+    return std::move(b);
+}
+
+big_integer operator|(big_integer const &a, big_integer &&b) {
+    b |= a;
+    return std::move(b);
+}
+
+big_integer operator^(big_integer const &a, big_integer &&b) {
+    b ^= a;
+    return std::move(b);
 }
 
 big_integer operator<<(big_integer a, int b) {
-    return a <<= b;
+    a <<= b;
+    return a;
 }
 
 big_integer operator>>(big_integer a, int b) {
-    return a >>= b;
+    a >>= b;
+    return a;
 }
 
 int32_t comparator(big_integer const &a, big_integer const &b) {
     if (a.sign != b.sign) {
         return a.sign ? -1 : 1;
     }
+    limb_t const *ad = a.data.data(), *bd = b.data.data();
     for (size_t index = std::max(a.data.size(), b.data.size()); index + 1 > index; index--) {
-        uint32_t a_value = index < a.data.size() ? a.data[index] : a.empty_block(),
-                 b_value = index < b.data.size() ? b.data[index] : b.empty_block();
+        limb_t a_value = index < a.data.size() ? ad[index] : a.empty_block(),
+               b_value = index < b.data.size() ? bd[index] : b.empty_block();
         if (a_value != b_value) {
             return a_value > b_value ? 1 : -1;
         }
@@ -373,18 +746,11 @@ std::string to_string(const big_integer &rhs) {
     if (rhs == 0) {
         return "0";
     }
-    big_integer x = abs(rhs);
     std::string res;
-    while (x > 0) {
-        std::pair<big_integer, uint32_t> div_mod_10 = x.div_by_uint32_t(10);
-        uint32_t cur = div_mod_10.second;
-        res.push_back(static_cast<char>(cur + '0'));
-        x = div_mod_10.first;
-    }
     if (rhs.sign) {
         res.push_back('-');
     }
-    reverse(res.begin(), res.end());
+    big_integer::to_decimal(abs(rhs), 0, res);
     return res;
 }
 
@@ -394,53 +760,153 @@ std::ostream &operator<<(std::ostream &s, big_integer const &a) {
 
 
 big_integer abs(big_integer const &a) {
-    return a.sign ? -a : a;
+    big_integer r = a.sign ? -a : a;
+    r.shrink_to_fit();
+    return r;
+}
+
+big_integer pow(big_integer const &base, unsigned int exponent) {
+    big_integer result = 1;
+    unsigned int bit = ~(~0u >> 1);
+    while (bit > exponent) {
+        bit >>= 1;
+    }
+    for (; bit != 0; bit >>= 1) {
+        result *= result;
+        if (exponent & bit) {
+            result *= base;
+        }
+    }
+    return result;
 }
 
 
-uint32_t big_integer::empty_block() const {
-    return sign ? UINT32_MAX : 0;
+limb_t big_integer::empty_block() const {
+    return sign ? LIMB_MAX : 0;
 }
 
 
+void big_integer::negate() {
+    // -x = ~x + 1, with one extra limb for the carry into the sign
+    data.resize(data.size() + 1, empty_block());
+    limb_t *d = data.mutable_data();
+    limb_t carry = 1;
+    for (size_t i = 0; i < data.size(); i++) {
+        d[i] = add_with_carry(~d[i], 0, carry);
+    }
+    set_sign();
+    shrink_to_fit();
+}
+
+void big_integer::extend(limb_t top) {
+    sign = top >> (LIMB_BITS - 1);
+    if (top != empty_block()) {
+        data.resize(data.size() + 1, top);
+    }
+}
+
 void big_integer::set_sign() { // in some cases shrink_to_fit is used without set_sign
-    sign = data.back() >> 31;
+    sign = data.back() >> (LIMB_BITS - 1);
 }
 
-std::pair<big_integer, uint32_t> big_integer::div_by_uint32_t(uint32_t const rhs) const {
+std::pair<big_integer, limb_t> big_integer::div_by_limb(limb_t const rhs) const {
     if (rhs == 0) {
         throw std::runtime_error("division by zero");
     }
     big_integer res;
     res.data.resize(data.size(), 0);
-    uint64_t temp = 0;
-    for (ptrdiff_t i = res.data.size() - 1; i >= 0; i--) {
-        temp = (temp << BIT_DEPTH) + data[i];
-        res.data[i] = static_cast<uint32_t>(temp / rhs);
-        temp %= rhs;
-    }
+    limb_t rem = limb_ops::divrem_1(res.data.mutable_data(), data.data(), data.size(), rhs);
     res.shrink_to_fit();
-    return std::make_pair(res, temp);
+    return std::make_pair(res, rem);
 }
 
-big_integer big_integer::mul_by_uint32_t(uint32_t const rhs) const {
-    big_integer res;
-    uint64_t carry = 0;
-    res.data.resize(data.size() + 1, 0);
-    for (size_t i = 0; i < data.size(); i++) {
-        carry = static_cast<uint64_t>(data[i]) * rhs + carry;
-        res.data[i] = static_cast<uint32_t>(carry);
-        carry >>= BIT_DEPTH;
+void big_integer::shrink_to_fit() {
+    while (!data.empty() && data.back() == empty_block()) {
+        data.pop_back();
     }
-    if (carry > 0) {
-        res.data[data.size()] = carry;
+}
+
+// 10^(CHUNK_DIGITS * 2^k), computed once per thread by repeated squaring.
+// The cache outlives any arena, so it is always built from the default pool
+big_integer const &big_integer::power_of_ten(size_t k) {
+    thread_local std::vector<big_integer> cache;
+    if (cache.size() > k) {
+        return cache[k];
     }
-    res.shrink_to_fit();
-    return res;
+    limb_memory::scoped_resource heap(nullptr);
+    while (cache.size() <= k) {
+        big_integer next;
+        if (cache.empty()) {
+            next.data.resize(1, CHUNK);
+        } else {
+            next = cache.back().square();
+        }
+        cache.push_back(next);
+    }
+    return cache[k];
 }
 
-void big_integer::shrink_to_fit() {
-    while (!data.empty() && data.back() == empty_block()) {
-        data.pop_back();
+big_integer big_integer::from_decimal(char const *digits, size_t length) {
+    if (length > CHUNK_DIGITS * DECIMAL_SPLIT_THRESHOLD) {
+        size_t k = 0;
+        while ((CHUNK_DIGITS << (k + 1)) <= length / 2) {
+            k++;
+        }
+        size_t low = CHUNK_DIGITS << k;
+        big_integer result = from_decimal(digits, length - low);
+        result *= power_of_ten(k);
+        return result += from_decimal(digits + length - low, low);
     }
-}
\ No newline at end of file
+
+    big_integer result;
+    result.data.resize(length / CHUNK_DIGITS + 2, 0);
+    limb_t *buffer = result.data.mutable_data();
+    size_t n = 0;
+    for (size_t i = 0; i < length;) {
+        size_t chunk_length = i == 0 && length % CHUNK_DIGITS != 0 ? length % CHUNK_DIGITS : CHUNK_DIGITS;
+        limb_t chunk = limb_ops::parse_decimal(digits + i, chunk_length), scale = 1;
+        for (size_t j = 0; j < chunk_length; j++) {
+            scale *= 10;
+        }
+        i += chunk_length;
+        buffer[n] = limb_ops::mul_1(buffer, buffer, n, scale);
+        limb_ops::add_in_place(buffer, n + 1, &chunk, 1);
+        n += buffer[n] != 0;
+    }
+    result.shrink_to_fit();
+    return result;
+}
+
+// appends the decimal digits of x >= 0, left-padded with zeros to width
+void big_integer::to_decimal(big_integer const &x, size_t width, std::string &out) {
+    if (x.data.size() > DECIMAL_SPLIT_THRESHOLD) {
+        size_t k = 0;
+        while (power_of_ten(k + 1).data.size() * 2 <= x.data.size()) {
+            k++;
+        }
+        big_integer const &divisor = power_of_ten(k);
+        std::pair<big_integer, big_integer> qr = divrem_dispatch(x, divisor);
+        size_t low = CHUNK_DIGITS << k;
+        to_decimal(qr.first, width > low ? width - low : 0, out);
+        to_decimal(qr.second, low, out);
+        return;
+    }
+
+    std::pmr::vector<limb_t> buffer(x.data.data(), x.data.data() + x.data.size(), limb_memory::resource());
+    size_t n = buffer.size();
+    std::string reversed;
+    while (n > 0) {
+        limb_t chunk = limb_ops::divrem_1(buffer.data(), buffer.data(), n, CHUNK);
+        while (n > 0 && buffer[n - 1] == 0) {
+            n--;
+        }
+        for (size_t j = 0; j < CHUNK_DIGITS && (n > 0 || chunk > 0); j++) {
+            reversed.push_back(static_cast<char>('0' + chunk % 10));
+            chunk /= 10;
+        }
+    }
+    if (reversed.size() < width) {
+        out.append(width - reversed.size(), '0');
+    }
+    out.append(reversed.rbegin(), reversed.rend());
+}
@@ -1,14 +1,18 @@
 #pragma once
 
 #include <string>
-#include <functional>
+#include <utility>
 #include "my_vector.h"
 
+struct shifted_term;
+
 struct big_integer {
     big_integer();
 
     big_integer(big_integer const &other);
 
+    big_integer(big_integer &&other) noexcept;
+
     big_integer(int a);
 
     explicit big_integer(std::string const &str);
@@ -17,6 +21,8 @@ struct big_integer {
 
     big_integer &operator=(big_integer const &other);
 
+    big_integer &operator=(big_integer &&other) noexcept;
+
     big_integer& operator+=(big_integer const& rhs);
     big_integer& operator-=(big_integer const& rhs);
     big_integer& operator*=(big_integer const& rhs);
@@ -34,6 +40,20 @@ struct big_integer {
     big_integer operator-() const;
     big_integer operator~() const;
 
+    // *this * *this, at roughly half the cost of a general multiplication
+    big_integer square() const;
+
+    // *this = -*this in place
+    void negate();
+
+    // *this += a * b and *this -= a * b, accumulating into the limbs of *this
+    big_integer &addmul(big_integer const &a, big_integer const &b);
+    big_integer &submul(big_integer const &a, big_integer const &b);
+    big_integer &addmul_ui(big_integer const &a, uint32_t b);
+
+    // *this += b << shift for shift >= 0, without materializing the shifted b
+    big_integer &add_shifted(big_integer const &b, int shift);
+
     big_integer &operator++();
 
     const big_integer operator++(int);
@@ -56,43 +76,81 @@ struct big_integer {
 
     friend big_integer abs(big_integer const &a);
 
+    // quotient rounded toward zero and the remainder with the sign of a, from a single division
+    friend std::pair<big_integer, big_integer> divmod(big_integer const &a, big_integer const &b);
+
     friend std::string to_string(big_integer const &a);
 
 
 private:
 
-    static const uint32_t BIT_DEPTH = 32;
-    static const uint64_t BASE = static_cast<uint64_t>(1) + UINT32_MAX;
-
-    my_vector data;
+    // sign shares the last word of data where the compiler honours
+    // [[no_unique_address]] (GCC and Clang, also in C++17 mode); elsewhere it
+    // takes a word of its own
+    [[no_unique_address]] my_vector data;
     bool sign;
 
 
-    big_integer mul_by_uint32_t(uint32_t rhs) const;
-
-    friend big_integer square_mul(big_integer const & left, big_integer const & right);
+    friend big_integer schoolbook_mul(big_integer const & left, big_integer const & right);
     friend big_integer copy(big_integer const &left, size_t l, size_t r);
 
     static big_integer Karatsuba_mul(big_integer const & left, big_integer const & right);
+    static big_integer Ntt_mul(big_integer const & left, big_integer const & right);
+    static big_integer Toom3_mul(big_integer const & left, big_integer const & right);
+    static big_integer unbalanced_mul(big_integer const & left, big_integer const & right);
+    static big_integer signed_mul(big_integer const & left, big_integer const & right);
+    static big_integer square_dispatch(big_integer const & x);
+    // operands must be non-negative; passing the same object twice squares it
+    static big_integer mul_dispatch(big_integer const & left, big_integer const & right);
+
+    big_integer &accumulate_product(big_integer const &a, big_integer const &b, bool subtract);
+
+    static void add_shifted_limbs(limb_t *r, size_t width, big_integer const &x, int shift, bool negative);
+
+    std::pair<big_integer, limb_t> div_by_limb(limb_t rhs) const;
 
-    std::pair<big_integer, uint32_t> div_by_uint32_t(uint32_t rhs) const;
+    static std::pair<big_integer, big_integer> divrem_basecase(big_integer const &a, big_integer const &b);
+    static std::pair<big_integer, big_integer> divrem_recursive(big_integer const &a, big_integer const &b, size_t m);
+    static std::pair<big_integer, big_integer> divrem_dispatch(big_integer const &a, big_integer const &b);
+    static std::pair<big_integer, big_integer> divrem_shifted(big_integer const &a, big_integer const &y, int shift);
 
-    big_integer & common_fun_bits(big_integer const &rhs, const std::function<uint32_t(uint32_t, uint32_t)>& fn);
+    static big_integer const &power_of_ten(size_t k);
+    static big_integer from_decimal(char const *digits, size_t length);
+    static void to_decimal(big_integer const &x, size_t width, std::string &out);
+
+    template<typename Op>
+    big_integer & common_fun_bits(big_integer const &rhs);
     friend int32_t comparator(big_integer const &a, big_integer const &b);
+    friend struct modular_context;
+    friend big_integer sum_of_terms(shifted_term const *terms, size_t count);
 
     void set_sign();
 
+    // top is the limb just above the stored ones: sets the sign from it and
+    // appends it unless it only repeats the sign
+    void extend(limb_t top);
+
+    // Drops redundant sign-extension limbs; the capacity is kept for later growth.
+    // Values may carry such limbs between operations, code that relies on the
+    // minimal length (division, modular_context) works on normalized copies
     void shrink_to_fit();
 
-    uint32_t empty_block() const;
+    limb_t empty_block() const;
 
 };
 
+// |a|, normalized
 big_integer abs(big_integer const &a);
 
+big_integer pow(big_integer const &base, unsigned int exponent);
+
+std::pair<big_integer, big_integer> divmod(big_integer const &a, big_integer const &b);
+
 big_integer operator+(big_integer a, big_integer const &b);
+big_integer operator+(big_integer const &a, big_integer &&b);
 
 big_integer operator-(big_integer a, big_integer const &b);
+big_integer operator-(big_integer const &a, big_integer &&b);
 
 big_integer operator*(big_integer a, big_integer const &b);
 
@@ -101,10 +159,13 @@ big_integer operator/(big_integer a, big_integer const &b);
 big_integer operator%(big_integer a, big_integer const &b);
 
 big_integer operator&(big_integer a, big_integer const &b);
+big_integer operator&(big_integer const &a, big_integer &&b);
 
 big_integer operator|(big_integer a, big_integer const &b);
+big_integer operator|(big_integer const &a, big_integer &&b);
 
 big_integer operator^(big_integer a, big_integer const &b);
+big_integer operator^(big_integer const &a, big_integer &&b);
 
 big_integer operator<<(big_integer a, int b);
 big_integer operator>>(big_integer a, int b);
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "big_integer.h"
+
+// Opt-in lazy arithmetic. lazy(x) wraps a big_integer so that +, - and << build
+// a linear combination of left-shifted operands instead of temporaries; converting
+// the combination to big_integer evaluates it into a single allocation with one
+// pass per operand:
+//
+//     big_integer r = (lazy(a) << 128) + lazy(b) - (lazy(c) << 64);
+//
+// The combination only refers to its operands, so it must be converted within the
+// full expression that creates it (do not keep one in an auto variable).
+struct shifted_term {
+    big_integer const *value;
+    int shift;
+    bool negative;
+};
+
+// the sum of (negative ? -1 : 1) * (value << shift) over terms[0..count)
+big_integer sum_of_terms(shifted_term const *terms, size_t count);
+
+template<size_t N>
+struct lazy_sum {
+    std::array<shifted_term, N> terms;
+
+    operator big_integer() const {
+        return sum_of_terms(terms.data(), N);
+    }
+};
+
+inline lazy_sum<1> lazy(big_integer const &x) {
+    return lazy_sum<1>{{{{&x, 0, false}}}};
+}
+
+template<size_t N>
+lazy_sum<N> operator-(lazy_sum<N> a) {
+    for (shifted_term &t : a.terms) {
+        t.negative = !t.negative;
+    }
+    return a;
+}
+
+template<size_t N>
+lazy_sum<N> operator<<(lazy_sum<N> a, int shift) {
+    for (shifted_term &t : a.terms) {
+        t.shift += shift;
+    }
+    return a;
+}
+
+template<size_t N, size_t M>
+lazy_sum<N + M> operator+(lazy_sum<N> const &a, lazy_sum<M> const &b) {
+    lazy_sum<N + M> result;
+    for (size_t i = 0; i < N; i++) {
+        result.terms[i] = a.terms[i];
+    }
+    for (size_t i = 0; i < M; i++) {
+        result.terms[N + i] = b.terms[i];
+    }
+    return result;
+}
+
+template<size_t N, size_t M>
+lazy_sum<N + M> operator-(lazy_sum<N> const &a, lazy_sum<M> const &b) {
+    return a + -b;
+}
+
+template<size_t N>
+lazy_sum<N + 1> operator+(lazy_sum<N> const &a, big_integer const &b) {
+    return a + lazy(b);
+}
+
+template<size_t N>
+lazy_sum<N + 1> operator-(lazy_sum<N> const &a, big_integer const &b) {
+    return a - lazy(b);
+}
+
+// a temporary operand lives until the end of the full expression, which is
+// long enough; these only resolve the ambiguity with operator+(a, big_integer &&)
+template<size_t N>
+lazy_sum<N + 1> operator+(lazy_sum<N> const &a, big_integer &&b) {
+    return a + lazy(b);
+}
+
+template<size_t N>
+lazy_sum<N + 1> operator-(lazy_sum<N> const &a, big_integer &&b) {
+    return a - lazy(b);
+}
+
+template<size_t N>
+lazy_sum<N + 1> operator+(big_integer const &a, lazy_sum<N> const &b) {
+    return lazy(a) + b;
+}
+
+template<size_t N>
+lazy_sum<N + 1> operator-(big_integer const &a, lazy_sum<N> const &b) {
+    return lazy(a) - b;
+}
@@ -2,11 +2,15 @@
 #include <cassert>
 #include <cstdlib>
 #include <random>
+#include <thread>
 #include <vector>
 #include <utility>
 #include <gtest/gtest.h>
 
 #include "big_integer.h"
+#include "big_integer_expr.h"
+#include "modular_context.h"
+#include "limb_memory.h"
 #include "big_integer_gmp.h"
 
 TEST(correctness, two_plus_two) {
@@ -79,6 +83,24 @@ TEST(correctness, assignment_return_value) {
   EXPECT_TRUE(b == 7);
 }
 
+TEST(correctness, move_semantics) {
+  big_integer a = (big_integer(1) << 1000) - 7;
+  big_integer expected = a;
+  big_integer b(std::move(a));
+  EXPECT_EQ(expected, b);
+  EXPECT_EQ(0, a);
+
+  big_integer c = -5;
+  c = std::move(b);
+  EXPECT_EQ(expected, c);
+  EXPECT_EQ(0, b);
+
+  big_integer small = -5;
+  big_integer d(std::move(small));
+  EXPECT_EQ(-5, d);
+  EXPECT_EQ(0, small);
+}
+
 TEST(correctness, comparisons) {
   big_integer a = 100;
   big_integer b = 100;
@@ -165,6 +187,13 @@ TEST(correctness, sub_return_value) {
   EXPECT_EQ(3, a);
 }
 
+TEST(correctness, sub_self) {
+  big_integer a = big_integer("-123456789012345678901234567890");
+
+  a -= a;
+  EXPECT_EQ(0, a);
+}
+
 TEST(correctness, mul) {
   big_integer a = 5;
   big_integer b = 20;
@@ -192,6 +221,19 @@ TEST(correctness, mul_return_value) {
   EXPECT_EQ(20, a);
 }
 
+TEST(correctness, rvalue_operators) {
+  big_integer x = (big_integer(1) << 700) + 3, y = -(big_integer(1) << 500) + 11, z = 12345;
+  big_integer xy = x * y, yz = y * z;
+  EXPECT_EQ(xy + yz, x * y + y * z);
+  EXPECT_EQ(xy - yz, x * y - y * z);
+  EXPECT_EQ(x - yz, x - y * z);
+  EXPECT_EQ(z - xy, z - x * y);
+  EXPECT_EQ(x & yz, x & (y * z));
+  EXPECT_EQ(x | yz, x | (y * z));
+  EXPECT_EQ(y ^ xy, y ^ (x * y));
+  EXPECT_EQ(xy * 2 - z + yz, x * y + x * y - z + y * z);
+}
+
 TEST(correctness, div_) {
   big_integer a = 20;
   big_integer b = 5;
@@ -248,6 +290,17 @@ TEST(correctness, div_rounding_negative) {
   EXPECT_TRUE(c % d == -3);
 }
 
+TEST(correctness, divmod_signs) {
+  for (int a : {17, -17, 5, -5, 0}) {
+    for (int b : {5, -5, 17, -17, 1}) {
+      std::pair<big_integer, big_integer> qr = divmod(big_integer(a), big_integer(b));
+      EXPECT_EQ(big_integer(a / b), qr.first);
+      EXPECT_EQ(big_integer(a % b), qr.second);
+    }
+  }
+  EXPECT_THROW(divmod(big_integer(1), big_integer(0)), std::runtime_error);
+}
+
 TEST(correctness, div_return_value) {
   big_integer a = 100;
   big_integer b = 2;
@@ -280,6 +333,43 @@ TEST(correctness, negation_int_min) {
   EXPECT_EQ(b - 1, std::numeric_limits<int>::max());
 }
 
+TEST(correctness, negate) {
+  for (big_integer a : {big_integer(0), big_integer(1), big_integer(-1), big_integer(1) << 63,
+                        -(big_integer(1) << 63), big_integer(1) << 64, -(big_integer(1) << 64), (big_integer(1) << 640) - 1}) {
+    big_integer b = a;
+    b.negate();
+    EXPECT_EQ(-a, b);
+    b.negate();
+    EXPECT_EQ(a, b);
+  }
+}
+
+TEST(correctness, unnormalized_results) {
+  // results of cancelling additions keep their width until they are observed
+  big_integer big = (big_integer(1) << 4000) + 12345;
+  big_integer small = big_integer(1) << 200;
+  big_integer d = (big + small) - big;
+  big_integer e = (big ^ small) ^ big;
+  EXPECT_EQ(small, d);
+  EXPECT_EQ(small, e);
+  EXPECT_EQ(to_string(small), to_string(d));
+  EXPECT_EQ(big / small, big / d);
+  EXPECT_EQ(big % small, big % e);
+  EXPECT_EQ((big + 1) * small, (big + 1) * d);
+  EXPECT_EQ(big_integer(12345), (big - (big - 12345)) * 1);
+  modular_context context(d + 1);
+  EXPECT_EQ((big * big) % (small + 1), context.mulmod(big, big));
+  EXPECT_EQ(d, context.reduce(d));
+
+  big_integer top = big_integer(1) << (LIMB_BITS - 1);
+  EXPECT_EQ(top * 2, top + top);
+  EXPECT_EQ(-top * 2, -top - top);
+  EXPECT_EQ(-top - 1, (-top) + (-1));
+  EXPECT_EQ(big_integer(0), top - top);
+  EXPECT_EQ(top - 1, top + (-1));
+  EXPECT_TRUE(-top < top - top);
+}
+
 TEST(correctness, and_) {
   big_integer a = 0x55;
   big_integer b = 0xaa;
@@ -491,6 +581,26 @@ TEST(correctness, mul_long_pow2) {
   EXPECT_EQ(c, b * b);
 }
 
+TEST(correctness, square_all_ones) {
+  // all-ones halves make every half sum carry out
+  for (int bits : {64 * 31, 64 * 32, 64 * 33, 64 * 100 + 5, 64 * 2000}) {
+    big_integer a = (big_integer(1) << bits) - 1;
+    EXPECT_EQ((big_integer(1) << (2 * bits)) - (big_integer(1) << (bits + 1)) + 1, a.square());
+    EXPECT_EQ(a.square(), (-a).square());
+  }
+}
+
+TEST(correctness, mul_huge_all_ones) {
+  // every limb is all ones, which maximizes the convolution coefficients
+  int const k = 32 * 200000, j = 32 * 150000 + 7;
+  big_integer a = (big_integer(1) << k) - 1;
+  big_integer b = (big_integer(1) << j) - 1;
+  big_integer expected = (big_integer(1) << (k + j)) - (big_integer(1) << k) - (big_integer(1) << j) + 1;
+
+  EXPECT_EQ(expected, a * b);
+  EXPECT_EQ((big_integer(1) << (2 * k)) - (big_integer(1) << (k + 1)) + 1, a * a);
+}
+
 TEST(correctness, div_long) {
   big_integer a("10000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000");
   big_integer b("100000000000000000000000000000000000000");
@@ -516,6 +626,19 @@ TEST(correctness, div_long_signed2) {
   EXPECT_EQ(c, a / b);
 }
 
+TEST(correctness, div_remainder_near_divisor) {
+  // divisors with a small top limb and remainders just below the divisor
+  // exercise the quotient digit correction steps
+  big_integer b = (big_integer(1) << 300) + (big_integer(1) << 200) - 1;
+  big_integer q = (big_integer(1) << 500) - (big_integer(1) << 130) + 12345;
+  for (big_integer r : {big_integer(0), b - 1, b / 2}) {
+    big_integer a = q * b + r;
+    EXPECT_EQ(q, a / b);
+    EXPECT_EQ(r, a % b);
+    EXPECT_EQ(-q, -a / b);
+  }
+}
+
 TEST(correctness, negation_long) {
   big_integer a("10000000000000000000000000000000000000000000000000000");
   big_integer c("-10000000000000000000000000000000000000000000000000000");
@@ -547,6 +670,43 @@ TEST(correctness, shr_long) {
 
 }
 
+TEST(correctness, lazy_sum) {
+  big_integer a = (big_integer(1) << 300) - 5, b = -(big_integer(1) << 200) + 77, c = -1, d = 0;
+  EXPECT_EQ((a << 130) + b - (c << 64), big_integer((lazy(a) << 130) + b - (lazy(c) << 64)));
+  EXPECT_EQ(-a - b + d, big_integer(-lazy(a) - b + d));
+  EXPECT_EQ(b - (a << 1) + (b << 63) - (c << 7), big_integer(b - (lazy(a) << 1) + (lazy(b) << 63) - (lazy(c) << 7)));
+  EXPECT_EQ(0, big_integer(lazy(a) - a));
+  EXPECT_EQ(a * b + 3, big_integer(lazy(a * b) + 3));
+}
+
+TEST(correctness, addmul_aliasing) {
+  big_integer a("-123456789012345678901234567890123456789");
+  big_integer b = a;
+  EXPECT_EQ(b + b * b, a.addmul(a, a));
+  a = b;
+  EXPECT_EQ(b - b * b, a.submul(a, a));
+  a = b;
+  EXPECT_EQ(b + b * big_integer("4000000000"), a.addmul_ui(a, 4000000000u));
+  a = b;
+  EXPECT_EQ(b + (b << 70), a.add_shifted(a, 70));
+  a = 0;
+  EXPECT_EQ(0, a.submul(b, 0));
+  EXPECT_EQ(0, a.add_shifted(0, 1000));
+}
+
+TEST(correctness, addmul_negative_powers_of_two) {
+  // at a limb boundary the magnitude of -2^k is one limb longer than its stored limbs
+  for (int k : {0, 31, 32, 63, 64, 65}) {
+    big_integer x = -(big_integer(1) << k);
+    big_integer a = 5;
+    EXPECT_EQ(5 + x * x, a.addmul(x, x));
+    a = x;
+    EXPECT_EQ(x - x * 3, a.submul(a, 3));
+    a = x;
+    EXPECT_EQ(x + x * x, a.addmul(x, a));
+  }
+}
+
 TEST(correctness, string_conv) {
   EXPECT_EQ("100", to_string(big_integer("100")));
   EXPECT_EQ("100", to_string(big_integer("0100")));
@@ -564,6 +724,231 @@ TEST(correctness, string_conv) {
   EXPECT_EQ("-2147483649", to_string(lim));
 }
 
+TEST(correctness, string_conv_signed_chunks) {
+  // 16 and 19 digits after a sign take the 16-digit packing path
+  EXPECT_EQ("1234567890123456", to_string(big_integer("+1234567890123456")));
+  EXPECT_EQ("-9876543210987654", to_string(big_integer("-9876543210987654")));
+  EXPECT_EQ("1234567890123456789", to_string(big_integer("+1234567890123456789")));
+  EXPECT_EQ("-9999999999999999999", to_string(big_integer("-9999999999999999999")));
+  EXPECT_EQ(pow(big_integer(10), 15), big_integer("+1000000000000000"));
+  EXPECT_EQ(-(pow(big_integer(10), 19) - 1), big_integer("-9999999999999999999"));
+  EXPECT_EQ(big_integer(1234567890) * 1000000000 + 123456789, big_integer("+1234567890123456789"));
+}
+
+TEST(correctness, string_conv_invalid) {
+  // 55 digits: one 32-byte block, one 16-byte block and a 7-byte scalar tail
+  std::string digits;
+  for (size_t i = 0; i < 55; i++) {
+    digits.push_back(static_cast<char>('0' + i % 10));
+  }
+  EXPECT_NO_THROW(big_integer{digits});
+  EXPECT_NO_THROW(big_integer{"-" + digits});
+  char const bad[] = {'/', ':', 'a', ' ', static_cast<char>(0x80), static_cast<char>(0xFF), '\0'};
+  size_t const positions[] = {0, 13, 31, 32, 40, 47, 48, 54};
+  for (char c : bad) {
+    for (size_t i : positions) {
+      std::string s = digits;
+      s[i] = c;
+      EXPECT_THROW(big_integer{s}, std::runtime_error) << "byte " << int(c) << " at " << i;
+      EXPECT_THROW(big_integer{"+" + s}, std::runtime_error) << "byte " << int(c) << " at " << i;
+      EXPECT_THROW(big_integer{s.substr(0, i + 1)}, std::runtime_error) << "byte " << int(c) << " at " << i;
+    }
+  }
+  EXPECT_THROW(big_integer("--1"), std::runtime_error);
+  EXPECT_THROW(big_integer("1-"), std::runtime_error);
+}
+
+TEST(correctness, pow) {
+  big_integer power = 1;
+  for (unsigned int i = 0; i < 200; i++) {
+    EXPECT_EQ(power, pow(big_integer(-3), i));
+    power *= -3;
+  }
+  EXPECT_EQ(big_integer(1) << 100000, pow(big_integer(2), 100000));
+  EXPECT_EQ(1, pow(big_integer(0), 0));
+}
+
+TEST(correctness, modular_context_fermat) {
+  // 2^521 - 1 is prime, so a^(p - 1) = 1 and a^p = a modulo it
+  big_integer p = (big_integer(1) << 521) - 1;
+  modular_context ctx(p);
+  for (big_integer a : {big_integer(2), big_integer(3), (big_integer(1) << 300) + 12345, p - 1}) {
+    EXPECT_EQ(1, ctx.powmod(a, p - 1));
+    EXPECT_EQ(a, ctx.powmod(a, p));
+  }
+  EXPECT_EQ(1, ctx.powmod(p + 5, 0));
+  EXPECT_EQ(p - 4, ctx.reduce(-p - 4));
+  EXPECT_THROW(modular_context(0), std::runtime_error);
+  EXPECT_THROW(ctx.powmod(2, -1), std::runtime_error);
+}
+
+namespace {
+  // counts the allocations passed on to operator new
+  struct counting_resource : std::pmr::memory_resource {
+    size_t allocations = 0;
+
+    void *do_allocate(size_t bytes, size_t alignment) override {
+      allocations++;
+      return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+      std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override {
+      return this == &other;
+    }
+  };
+}
+
+TEST(correctness, arena_steady_state) {
+  counting_resource upstream;
+  limb_memory::arena arena(1024, &upstream);
+  big_integer a = (big_integer(1) << 5000) - 12345;
+  big_integer b = (big_integer(7) << 3000) + 1;
+  big_integer result;
+  for (int round = 0; round < 3; round++) {
+    size_t before = upstream.allocations;
+    {
+      limb_memory::scoped_resource use(&arena);
+      big_integer q = a * a / b;
+      result = q % (b >> 1000) + pow(b, 3);
+      EXPECT_EQ(a * a, b * q + a * a % b);
+    }
+    big_integer kept = result;
+    result = 0;
+    arena.reset();
+    EXPECT_EQ(pow(b, 3) + a * a / b % (b >> 1000), kept);
+    if (round > 0) {
+      EXPECT_EQ(before, upstream.allocations);
+    }
+  }
+  EXPECT_GT(arena.capacity(), 0u);
+}
+
+TEST(correctness, arena_keeps_existing_buffers) {
+  // growing or unsharing a value from outside the scope must not move it into the arena
+  big_integer acc = big_integer(1) << 2000;
+  big_integer shared = acc;
+  {
+    limb_memory::arena arena;
+    {
+      limb_memory::scoped_resource use(&arena);
+      acc += big_integer(1) << 9000;
+      shared += 1;
+    }
+    arena.reset();
+  }
+  EXPECT_EQ((big_integer(1) << 9000) + (big_integer(1) << 2000), acc);
+  EXPECT_EQ((big_integer(1) << 2000) + 1, shared);
+}
+
+TEST(correctness, arena_decimal_cache) {
+  std::string digits(3000, '7');
+  {
+    limb_memory::scoped_resource use(&limb_memory::thread_arena());
+    EXPECT_EQ(digits, to_string(big_integer(digits)));
+  }
+  limb_memory::thread_arena().reset();
+  EXPECT_EQ(digits, to_string(big_integer(digits)));
+}
+
+TEST(correctness, pool_recycles) {
+  std::pmr::memory_resource *pool = limb_memory::pool();
+  void *p = pool->allocate(200, alignof(limb_t));
+  pool->deallocate(p, 200, alignof(limb_t));
+  void *q = pool->allocate(150, alignof(limb_t));
+  EXPECT_EQ(p, q);
+  pool->deallocate(q, 150, alignof(limb_t));
+}
+
+TEST(correctness, pool_across_threads) {
+  // values built on one thread and released on another go to the releasing thread's lists
+  std::vector<big_integer> values;
+  std::thread producer([&values] {
+    for (int i = 0; i < 100; i++) {
+      values.push_back((big_integer(i + 1) << (64 * (i % 40) + 600)) - 1);
+    }
+  });
+  producer.join();
+  std::thread consumer([&values] {
+    for (big_integer &x : values) {
+      x = x * x + 1;
+    }
+  });
+  consumer.join();
+  for (int i = 0; i < 100; i++) {
+    big_integer x = (big_integer(i + 1) << (64 * (i % 40) + 600)) - 1;
+    EXPECT_EQ(x * x + 1, values[i]);
+  }
+}
+
+TEST(correctness, inline_values_do_not_allocate) {
+  if (my_vector::INLINE_LIMBS < 3) {
+    return;  // no room for a value limb with its sign and carry limbs
+  }
+  size_t bits = std::min<size_t>(512, (my_vector::INLINE_LIMBS - 2) * LIMB_BITS);
+  big_integer a = (big_integer(1) << static_cast<int>(bits)) - 1;
+  big_integer b = -(a >> 7);
+  big_integer expected = ((a + b) ^ (a - b)) + (b << 3) - a * 12345;
+  counting_resource counter;
+  limb_memory::scoped_resource use(&counter);
+  big_integer x = a;
+  x += b;
+  big_integer y = a - b;
+  x ^= y;
+  x += b << 3;
+  x -= a * 12345;
+  EXPECT_EQ(expected, x);
+  EXPECT_EQ(0u, counter.allocations);
+}
+
+TEST(correctness, my_vector_capacity) {
+  my_vector v;
+  EXPECT_EQ(my_vector::INLINE_LIMBS, v.capacity());
+  v.reserve(100);
+  EXPECT_EQ(0u, v.size());
+  EXPECT_GE(v.capacity(), 100u);
+  v.resize(100, 1);
+  limb_t const *limbs = v.data();
+  while (v.size() > 1) {
+    v.pop_back();
+  }
+  v.resize(100, 2);
+  EXPECT_EQ(limbs, v.data());
+  EXPECT_EQ(1u, v[0]);
+  EXPECT_EQ(2u, v[99]);
+  size_t capacity = v.capacity();
+  v.resize(capacity + 1, 0);
+  EXPECT_GE(v.capacity(), 2 * capacity);
+
+  basic_my_vector<3> w(2);
+  EXPECT_EQ(3u, w.capacity());
+  w.resize(5, 7);
+  basic_my_vector<3> copy = w;
+  EXPECT_EQ(5u, copy.size());
+  EXPECT_EQ(7u, copy[4]);
+}
+
+TEST(correctness, growing_sum_allocations) {
+  std::vector<big_integer> terms;
+  for (int i = 0; i < 2000; i++) {
+    terms.push_back(big_integer(i + 1) << (8 * i));
+  }
+  counting_resource counter;
+  limb_memory::scoped_resource use(&counter);
+  big_integer sum;
+  for (big_integer const &term : terms) {
+    sum += term;
+  }
+  EXPECT_LE(counter.allocations, 16u);
+  for (int i = 0; i < 2000; i++) {
+    sum -= terms[i];
+  }
+  EXPECT_EQ(0, sum);
+}
+
 namespace {
 size_t const number_of_iterations = 10;
 size_t const max_size = 2048;
@@ -731,6 +1116,33 @@ TEST(correctness_random, mul) {
   }
 }
 
+TEST(correctness_random, mul_large) {
+  std::default_random_engine rng(42);
+  for (size_t size : {1000, 4000, 12000, 40000, 100000}) {
+    big_integer_gmp a, b;
+    a.random(size, rng);
+    b.random(size - size / 3, rng);
+    big_integer_gmp c = a * b;
+    big_integer R = big_integer(to_string(a)) * big_integer(to_string(b));
+    EXPECT_EQ(to_string(c), to_string(R));
+
+    c = a * a;
+    R = big_integer(to_string(a)) * big_integer(to_string(a));
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
+TEST(correctness_random, square) {
+  std::default_random_engine rng(5);
+  for (size_t size : {1, 63, 64, 65, 500, 2047, 2100, 5000, 40000, 200000}) {
+    big_integer_gmp a;
+    a.random(size, rng);
+    big_integer A(to_string(a));
+    EXPECT_EQ(to_string(a * a), to_string(A.square()));
+  }
+  EXPECT_EQ(0, big_integer().square());
+}
+
 TEST(correctness_random, div) {
   std::default_random_engine rng(322);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
@@ -747,6 +1159,129 @@ TEST(correctness_random, div) {
   }
 }
 
+TEST(correctness_random, div_large) {
+  std::default_random_engine rng(7);
+  for (size_t size : {20000, 70000, 200000}) {
+    big_integer_gmp a, b;
+    a.random(size, rng);
+    for (size_t divisor_size : {size / 2, size / 3, size / 5, size_t(17000)}) {
+      b.random(divisor_size, rng);
+      big_integer A(to_string(a)), B(to_string(b));
+      EXPECT_EQ(to_string(a / b), to_string(A / B));
+      EXPECT_EQ(to_string(a % b), to_string(A % B));
+    }
+  }
+}
+
+TEST(correctness_random, divmod) {
+  std::default_random_engine rng(1337);
+  for (size_t size : {100, 3000, 40000}) {
+    big_integer_gmp a, b;
+    a.random(size, rng);
+    b.random(size / 3, rng);
+    std::pair<big_integer, big_integer> qr = divmod(big_integer(to_string(a)), big_integer(to_string(b)));
+    EXPECT_EQ(to_string(a / b), to_string(qr.first));
+    EXPECT_EQ(to_string(a % b), to_string(qr.second));
+  }
+}
+
+TEST(correctness_random, modular_context) {
+  std::default_random_engine rng(2024);
+  for (size_t size : {40, 64, 500, 4096, 20000}) {
+    big_integer_gmp a, b, m;
+    a.random(2 * size, rng);
+    b.random(size, rng);
+    m.random(size, rng);
+    // one odd and one even modulus of the same size
+    for (big_integer M : {abs(big_integer(to_string(m))) | 1, abs(big_integer(to_string(m))) & -2}) {
+      if (M == 0) {
+        continue;
+      }
+      modular_context ctx(M);
+      big_integer A(to_string(a)), B(to_string(b));
+      big_integer expected = (A * B) % M;
+      EXPECT_EQ(expected < 0 ? expected + M : expected, ctx.mulmod(A, B));
+      EXPECT_EQ((A * A) % M, ctx.sqrmod(A));
+
+      big_integer power = 1;
+      for (int i = 0; i < 13; i++) {
+        power = power * B % M;
+      }
+      EXPECT_EQ(power < 0 ? power + M : power, ctx.powmod(B, 13));
+    }
+  }
+}
+
+TEST(correctness_random, powmod_windows) {
+  // exponent lengths on both sides of every window size change, odd and even moduli
+  std::default_random_engine rng(99);
+  for (size_t size : {64, 1000, 2100}) {
+    big_integer_gmp m, x;
+    m.random(size, rng);
+    x.random(size, rng);
+    big_integer M = abs(big_integer(to_string(m))), X(to_string(x));
+    for (big_integer modulus : {M | 1, (M & -2) + 2}) {
+      modular_context ctx(modulus);
+      powmod_table table(ctx, X, 700);
+      for (size_t bits : {1, 7, 8, 25, 81, 241, 673, 700, 701}) {
+        big_integer e = (big_integer(1) << static_cast<int>(bits - 1)) + big_integer(static_cast<int>(rng() % 1000000));
+        if (bits < 21) {
+          e = big_integer(1) << static_cast<int>(bits - 1);
+        }
+        big_integer expected = 1, base = ctx.reduce(X);
+        big_integer rest = e;
+        // right-to-left binary exponentiation with plain * and %
+        while (rest > 0) {
+          if ((rest & 1) == 1) {
+            expected = expected * base % modulus;
+          }
+          base = base * base % modulus;
+          rest >>= 1;
+        }
+        EXPECT_EQ(expected, ctx.powmod(X, e));
+        EXPECT_EQ(expected, table.pow(e));
+        EXPECT_EQ(expected, powmod(X, e, modulus));
+      }
+      EXPECT_EQ(1, table.pow(0));
+    }
+  }
+}
+
+TEST(correctness_random, lazy_sum) {
+  std::default_random_engine rng(11);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp x, y, z;
+    x.random(max_size, rng);
+    y.random(max_size / 3, rng);
+    z.random(64, rng);
+    big_integer X(to_string(x)), Y(to_string(y)), Z(to_string(z));
+    int s1 = static_cast<int>(rng() % 200), s2 = static_cast<int>(rng() % 200);
+    EXPECT_EQ((X << s1) - (Y << s2) + Z - X, big_integer((lazy(X) << s1) - (lazy(Y) << s2) + Z - X));
+  }
+}
+
+TEST(correctness_random, addmul) {
+  std::default_random_engine rng(20);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp x, y, z;
+    x.random(max_size, rng);
+    y.random(rng() % 2 ? max_size / 2 : 100, rng);
+    z.random(rng() % 2 ? max_size : 64, rng);
+    big_integer X(to_string(x)), Y(to_string(y)), Z(to_string(z));
+    int shift = static_cast<int>(rng() % 300);
+    uint32_t small = static_cast<uint32_t>(rng());
+
+    big_integer r = Z;
+    EXPECT_EQ(Z + X * Y, r.addmul(X, Y));
+    r = Z;
+    EXPECT_EQ(Z - X * Y, r.submul(Y, X));
+    r = Z;
+    EXPECT_EQ(Z + X * big_integer(small), r.addmul_ui(X, small));
+    r = Z;
+    EXPECT_EQ(Z + (X << shift), r.add_shifted(X, shift));
+  }
+}
+
 TEST(correctness_random, mod) {
   std::default_random_engine rng(322);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
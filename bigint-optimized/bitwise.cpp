@@ -0,0 +1,93 @@
+#include "limb_ops.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Bitwise kernels are picked once per operation at first use, by the widest
+// vector extension the running CPU supports.
+namespace {
+    using bitwise_kernel = void (*)(limb_t *, limb_t const *, limb_t const *, size_t);
+
+    template<typename Op>
+    void bitwise_generic(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        Op op;
+        for (size_t i = 0; i < n; i++) {
+            r[i] = op(a[i], b[i]);
+        }
+    }
+
+#if defined(__x86_64__)
+    __attribute__((target("avx2"))) __m256i apply(limb_ops::bit_and, __m256i a, __m256i b) {
+        return _mm256_and_si256(a, b);
+    }
+
+    __attribute__((target("avx2"))) __m256i apply(limb_ops::bit_or, __m256i a, __m256i b) {
+        return _mm256_or_si256(a, b);
+    }
+
+    __attribute__((target("avx2"))) __m256i apply(limb_ops::bit_xor, __m256i a, __m256i b) {
+        return _mm256_xor_si256(a, b);
+    }
+
+    __attribute__((target("avx512f"))) __m512i apply(limb_ops::bit_and, __m512i a, __m512i b) {
+        return _mm512_and_si512(a, b);
+    }
+
+    __attribute__((target("avx512f"))) __m512i apply(limb_ops::bit_or, __m512i a, __m512i b) {
+        return _mm512_or_si512(a, b);
+    }
+
+    __attribute__((target("avx512f"))) __m512i apply(limb_ops::bit_xor, __m512i a, __m512i b) {
+        return _mm512_xor_si512(a, b);
+    }
+
+    template<typename Op>
+    __attribute__((target("avx2"))) void bitwise_avx2(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        const size_t step = sizeof(__m256i) / sizeof(limb_t);
+        size_t i = 0;
+        for (; i + step <= n; i += step) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+            __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), apply(Op(), x, y));
+        }
+        bitwise_generic<Op>(r + i, a + i, b + i, n - i);
+    }
+
+    template<typename Op>
+    __attribute__((target("avx512f"))) void bitwise_avx512(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+        const size_t step = sizeof(__m512i) / sizeof(limb_t);
+        size_t i = 0;
+        for (; i + step <= n; i += step) {
+            __m512i x = _mm512_loadu_si512(a + i);
+            __m512i y = _mm512_loadu_si512(b + i);
+            _mm512_storeu_si512(r + i, apply(Op(), x, y));
+        }
+        bitwise_generic<Op>(r + i, a + i, b + i, n - i);
+    }
+#endif
+
+    template<typename Op>
+    bitwise_kernel select_kernel() {
+#if defined(__x86_64__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return bitwise_avx512<Op>;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return bitwise_avx2<Op>;
+        }
+#endif
+        return bitwise_generic<Op>;
+    }
+}
+
+template<typename Op>
+void limb_ops::bitwise_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    static const bitwise_kernel kernel = select_kernel<Op>();
+    kernel(r, a, b, n);
+}
+
+template void limb_ops::bitwise_n<limb_ops::bit_and>(limb_t *, limb_t const *, limb_t const *, size_t);
+template void limb_ops::bitwise_n<limb_ops::bit_or>(limb_t *, limb_t const *, limb_t const *, size_t);
+template void limb_ops::bitwise_n<limb_ops::bit_xor>(limb_t *, limb_t const *, limb_t const *, size_t);
@@ -0,0 +1,109 @@
+#include "limb_ops.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Decimal scanning: digits are validated 32 (AVX2) or 16 (SSE2) bytes at a time
+// and converted 16 (SSSE3 multiply-add) or 8 (SWAR multiply) digits at a time.
+namespace {
+    bool is_decimal_scalar(char const *s, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            if (s[i] < '0' || '9' < s[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#if defined(__x86_64__)
+    bool is_decimal_sse2(char const *s, size_t n) {
+        const __m128i lower = _mm_set1_epi8('0' - 1), upper = _mm_set1_epi8('9' + 1);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const *>(s + i));
+            __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(x, lower), _mm_cmplt_epi8(x, upper));
+            if (_mm_movemask_epi8(ok) != 0xFFFF) {
+                return false;
+            }
+        }
+        return is_decimal_scalar(s + i, n - i);
+    }
+
+    __attribute__((target("avx2"))) bool is_decimal_avx2(char const *s, size_t n) {
+        const __m256i lower = _mm256_set1_epi8('0' - 1), upper = _mm256_set1_epi8('9' + 1);
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(s + i));
+            __m256i ok = _mm256_and_si256(_mm256_cmpgt_epi8(x, lower), _mm256_cmpgt_epi8(upper, x));
+            if (_mm256_movemask_epi8(ok) != -1) {
+                return false;
+            }
+        }
+        return is_decimal_sse2(s + i, n - i);
+    }
+
+    // value of exactly 16 digits
+    __attribute__((target("ssse3"))) uint64_t parse_16_ssse3(char const *s) {
+        __m128i x = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(s)), _mm_set1_epi8('0'));
+        x = _mm_maddubs_epi16(x, _mm_set_epi8(1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10));
+        x = _mm_madd_epi16(x, _mm_set_epi16(1, 100, 1, 100, 1, 100, 1, 100));
+        x = _mm_packs_epi32(x, x);
+        x = _mm_madd_epi16(x, _mm_set_epi16(1, 10000, 1, 10000, 1, 10000, 1, 10000));
+        uint64_t halves = static_cast<uint64_t>(_mm_cvtsi128_si64(x));
+        return (halves & 0xFFFFFFFF) * 100000000 + (halves >> 32);
+    }
+
+    bool has_ssse3() {
+        static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("ssse3"));
+        return supported;
+    }
+#endif
+
+    // value of exactly 8 digits
+    uint64_t parse_8(char const *s) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint64_t x;
+        std::memcpy(&x, s, sizeof(x));
+        x -= 0x3030303030303030;
+        x = (x * 10 + (x >> 8)) & 0x00FF00FF00FF00FF;
+        x = (x * 100 + (x >> 16)) & 0x0000FFFF0000FFFF;
+        return (x * 10000 + (x >> 32)) & 0xFFFFFFFF;
+#else
+        uint64_t x = 0;
+        for (size_t i = 0; i < 8; i++) {
+            x = x * 10 + static_cast<uint64_t>(s[i] - '0');
+        }
+        return x;
+#endif
+    }
+}
+
+bool limb_ops::is_decimal(char const *s, size_t n) {
+#if defined(__x86_64__)
+    static const bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+    return avx2 ? is_decimal_avx2(s, n) : is_decimal_sse2(s, n);
+#else
+    return is_decimal_scalar(s, n);
+#endif
+}
+
+limb_t limb_ops::parse_decimal(char const *s, size_t n) {
+    limb_t value = 0;
+    size_t i = 0;
+#if defined(__x86_64__)
+    if (LIMB_BITS == 64 && n >= 16 && has_ssse3()) {
+        value = static_cast<limb_t>(parse_16_ssse3(s));
+        i = 16;
+    }
+#endif
+    for (; i + 8 <= n; i += 8) {
+        value = value * 100000000 + static_cast<limb_t>(parse_8(s + i));
+    }
+    for (; i < n; i++) {
+        value = value * 10 + static_cast<limb_t>(s[i] - '0');
+    }
+    return value;
+}
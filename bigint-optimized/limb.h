@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Width of a big_integer digit. 64-bit limbs need a 128-bit type for products,
+// so they are the default only where the compiler provides one.
+#ifndef BIGINT_LIMB_BITS
+#if defined(__SIZEOF_INT128__)
+#define BIGINT_LIMB_BITS 64
+#else
+#define BIGINT_LIMB_BITS 32
+#endif
+#endif
+
+#if BIGINT_LIMB_BITS == 64
+using limb_t = uint64_t;
+__extension__ using double_limb_t = unsigned __int128;
+#elif BIGINT_LIMB_BITS == 32
+using limb_t = uint32_t;
+using double_limb_t = uint64_t;
+#else
+#error "BIGINT_LIMB_BITS must be 32 or 64"
+#endif
+
+static const unsigned LIMB_BITS = BIGINT_LIMB_BITS;
+static const limb_t LIMB_MAX = ~static_cast<limb_t>(0);
+
+// a + b + carry, carry is 0 or 1 on entry and on exit
+inline limb_t add_with_carry(limb_t a, limb_t b, limb_t &carry) {
+#if defined(__x86_64__) && BIGINT_LIMB_BITS == 64
+    unsigned long long sum;
+    carry = _addcarry_u64(static_cast<unsigned char>(carry), a, b, &sum);
+    return sum;
+#else
+    double_limb_t sum = static_cast<double_limb_t>(a) + b + carry;
+    carry = static_cast<limb_t>(sum >> LIMB_BITS);
+    return static_cast<limb_t>(sum);
+#endif
+}
+
+// a - b - borrow, borrow is 0 or 1 on entry and on exit
+inline limb_t sub_with_borrow(limb_t a, limb_t b, limb_t &borrow) {
+#if defined(__x86_64__) && BIGINT_LIMB_BITS == 64
+    unsigned long long diff;
+    borrow = _subborrow_u64(static_cast<unsigned char>(borrow), a, b, &diff);
+    return diff;
+#else
+    double_limb_t diff = static_cast<double_limb_t>(a) - b - borrow;
+    borrow = static_cast<limb_t>(diff >> (2 * LIMB_BITS - 1));
+    return static_cast<limb_t>(diff);
+#endif
+}
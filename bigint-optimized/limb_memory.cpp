@@ -0,0 +1,185 @@
+#include "limb_memory.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+    thread_local std::pmr::memory_resource *current_resource = nullptr;
+
+    // classes of 2^MIN_CLASS_LOG .. 2^MAX_CLASS_LOG bytes
+    const size_t MIN_CLASS_LOG = 6;
+    const size_t MAX_CLASS_LOG = 16;
+    const size_t CLASSES = MAX_CLASS_LOG - MIN_CLASS_LOG + 1;
+
+    // bytes a thread keeps on each free list before handing blocks back to operator new
+    const size_t MAX_LIST_BYTES = 256 * 1024;
+
+    struct free_block {
+        free_block *next;
+    };
+
+    struct free_lists {
+        free_block *head[CLASSES] = {};
+        size_t length[CLASSES] = {};
+
+        ~free_lists();
+    };
+
+    // Thread-local objects may free buffers after this thread's lists are gone
+    // (the power-of-ten cache, for one); the flag has no destructor, so it stays
+    // readable during thread exit and sends those blocks to operator delete.
+    thread_local bool lists_destroyed = false;
+    thread_local free_lists lists;
+
+    size_t class_bytes(size_t c) {
+        return static_cast<size_t>(1) << (c + MIN_CLASS_LOG);
+    }
+
+    free_lists::~free_lists() {
+        for (size_t c = 0; c < CLASSES; c++) {
+            while (head[c]) {
+                free_block *next = head[c]->next;
+                ::operator delete(head[c], class_bytes(c));
+                head[c] = next;
+            }
+        }
+        lists_destroyed = true;
+    }
+
+    class size_class_pool : public std::pmr::memory_resource {
+        // the smallest class holding bytes, CLASSES if there is none
+        static size_t size_class(size_t bytes) {
+            size_t c = 0;
+            while (c < CLASSES && class_bytes(c) < bytes) {
+                c++;
+            }
+            return c;
+        }
+
+        void *do_allocate(size_t bytes, size_t alignment) override {
+            size_t c = size_class(bytes);
+            if (c == CLASSES || alignment > alignof(std::max_align_t)) {
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+            if (!lists_destroyed && lists.head[c]) {
+                free_block *block = lists.head[c];
+                lists.head[c] = block->next;
+                lists.length[c]--;
+                return block;
+            }
+            return ::operator new(class_bytes(c));
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+            size_t c = size_class(bytes);
+            if (c == CLASSES || alignment > alignof(std::max_align_t)) {
+                std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+                return;
+            }
+            if (lists_destroyed || (lists.length[c] + 1) * class_bytes(c) > MAX_LIST_BYTES) {
+                ::operator delete(p, class_bytes(c));
+                return;
+            }
+            free_block *block = static_cast<free_block *>(p);
+            block->next = lists.head[c];
+            lists.head[c] = block;
+            lists.length[c]++;
+        }
+
+        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override {
+            return this == &other;
+        }
+    };
+}
+
+std::pmr::memory_resource *limb_memory::pool() {
+    // never destroyed, buffers may be released by other threads during exit
+    static size_class_pool *instance = new size_class_pool();
+    return instance;
+}
+
+std::pmr::memory_resource *limb_memory::resource() {
+    return current_resource ? current_resource : pool();
+}
+
+std::pmr::memory_resource *limb_memory::set_resource(std::pmr::memory_resource *r) {
+    std::pmr::memory_resource *previous = resource();
+    current_resource = r;
+    return previous;
+}
+
+limb_memory::scoped_resource::scoped_resource(std::pmr::memory_resource *r) : previous(set_resource(r)) {}
+
+limb_memory::scoped_resource::~scoped_resource() {
+    set_resource(previous);
+}
+
+limb_memory::arena::arena(size_t initial_size, std::pmr::memory_resource *upstream)
+        : upstream(upstream), initial_size(std::max<size_t>(initial_size, 1)), head(nullptr), current(nullptr),
+          offset(0) {}
+
+limb_memory::arena::~arena() {
+    while (head) {
+        chunk *next = head->next;
+        upstream->deallocate(head, sizeof(chunk) + head->size, alignof(std::max_align_t));
+        head = next;
+    }
+}
+
+void limb_memory::arena::reset() {
+    current = head;
+    offset = 0;
+}
+
+size_t limb_memory::arena::capacity() const {
+    size_t total = 0;
+    for (chunk *c = head; c; c = c->next) {
+        total += c->size;
+    }
+    return total;
+}
+
+// links a new chunk of at least min_size bytes after the last one, doubling the chunk size each time
+limb_memory::arena::chunk *limb_memory::arena::append_chunk(size_t min_size) {
+    chunk *last = current;
+    while (last && last->next) {
+        last = last->next;
+    }
+    size_t size = std::max(last ? 2 * last->size : initial_size, min_size);
+    chunk *c = static_cast<chunk *>(upstream->allocate(sizeof(chunk) + size, alignof(std::max_align_t)));
+    c->next = nullptr;
+    c->size = size;
+    (last ? last->next : head) = c;
+    return c;
+}
+
+void *limb_memory::arena::do_allocate(size_t bytes, size_t alignment) {
+    // chunks too small for this request are skipped until the next reset
+    while (current) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(current->begin());
+        size_t start = (base + offset + alignment - 1) / alignment * alignment - base;
+        if (start + bytes <= current->size) {
+            offset = start + bytes;
+            return current->begin() + start;
+        }
+        if (!current->next) {
+            break;
+        }
+        current = current->next;
+        offset = 0;
+    }
+    current = append_chunk(bytes + alignment);
+    offset = 0;
+    return do_allocate(bytes, alignment);
+}
+
+void limb_memory::arena::do_deallocate(void *, size_t, size_t) {}
+
+bool limb_memory::arena::do_is_equal(std::pmr::memory_resource const &other) const noexcept {
+    return this == &other;
+}
+
+limb_memory::arena &limb_memory::thread_arena() {
+    thread_local arena a;
+    return a;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+// Where limb storage comes from. Every thread has a current memory resource
+// (the pool below by default) that serves the first heap buffer of a my_vector
+// and the scratch space of the arithmetic kernels. A buffer remembers the
+// resource it came from: it is returned there, and growing or unsharing a
+// value reallocates from the same resource. Copying a big_integer whose buffer
+// belongs to another resource makes a private copy in the current one, but
+// moving transfers the buffer as is, whatever resource is current.
+namespace limb_memory {
+    // Process-wide resource that rounds requests up to power-of-two size classes
+    // and recycles freed blocks through free lists owned by the freeing thread,
+    // so the common sizes are served without touching operator new or any lock.
+    // Requests above the largest class go straight to operator new.
+    std::pmr::memory_resource *pool();
+
+    // the current resource of this thread, never null
+    std::pmr::memory_resource *resource();
+
+    // makes r (the pool for nullptr) the current resource of this thread, returns the previous one
+    std::pmr::memory_resource *set_resource(std::pmr::memory_resource *r);
+
+    // sets the current resource for the lifetime of the guard
+    class scoped_resource {
+    public:
+        explicit scoped_resource(std::pmr::memory_resource *r);
+
+        scoped_resource(scoped_resource const &) = delete;
+
+        scoped_resource &operator=(scoped_resource const &) = delete;
+
+        ~scoped_resource();
+
+    private:
+        std::pmr::memory_resource *previous;
+    };
+
+    // Bump allocator that hands out memory from a list of chunks and never frees
+    // single allocations. reset() makes all chunks available again without
+    // returning them upstream, so a computation that is repeated after each reset
+    // stops allocating once the chunks have grown to its peak usage.
+    //
+    // Everything allocated from the arena, including big_integers holding its
+    // buffers, must be destroyed before reset() or the arena's destruction.
+    // Values created or assigned inside the scope hold arena buffers, and moving
+    // one into a longer-lived big_integer (acc = acc + x included) carries the
+    // buffer along; copy results out after the scoped_resource has ended.
+    class arena : public std::pmr::memory_resource {
+    public:
+        explicit arena(size_t initial_size = 64 * 1024,
+                       std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+
+        arena(arena const &) = delete;
+
+        arena &operator=(arena const &) = delete;
+
+        ~arena() override;
+
+        void reset();
+
+        // total size of the chunks obtained from upstream, in bytes
+        size_t capacity() const;
+
+    private:
+        struct chunk {
+            chunk *next;
+            size_t size;
+
+            char *begin() {
+                return reinterpret_cast<char *>(this + 1);
+            }
+        };
+
+        std::pmr::memory_resource *upstream;
+        size_t initial_size;
+        chunk *head;
+        chunk *current;
+        size_t offset;
+
+        chunk *append_chunk(size_t min_size);
+
+        void *do_allocate(size_t bytes, size_t alignment) override;
+
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+
+        bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override;
+    };
+
+    // an arena owned by the calling thread
+    arena &thread_arena();
+}
@@ -0,0 +1,307 @@
+#include "limb_ops.h"
+
+#include <algorithm>
+
+limb_t limb_ops::add_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        r[i] = add_with_carry(a[i], b[i], carry);
+    }
+    return carry;
+}
+
+limb_t limb_ops::sub_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        r[i] = sub_with_borrow(a[i], b[i], borrow);
+    }
+    return borrow;
+}
+
+limb_t limb_ops::add_in_place(limb_t *r, size_t n, limb_t const *b, size_t m) {
+    limb_t carry = add_n(r, r, b, m);
+    for (size_t i = m; carry != 0 && i < n; i++) {
+        carry = ++r[i] == 0;
+    }
+    return carry;
+}
+
+limb_t limb_ops::sub_in_place(limb_t *r, size_t n, limb_t const *b, size_t m) {
+    limb_t borrow = sub_n(r, r, b, m);
+    for (size_t i = m; borrow != 0 && i < n; i++) {
+        borrow = r[i]-- == 0;
+    }
+    return borrow;
+}
+
+limb_t limb_ops::mul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    double_limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        carry = static_cast<double_limb_t>(a[i]) * b + carry;
+        r[i] = static_cast<limb_t>(carry);
+        carry >>= LIMB_BITS;
+    }
+    return static_cast<limb_t>(carry);
+}
+
+limb_t limb_ops::divrem_1(limb_t *q, limb_t const *a, size_t n, limb_t d) {
+    double_limb_t rem = 0;
+    for (size_t i = n; i-- > 0;) {
+        rem = (rem << LIMB_BITS) + a[i];
+        q[i] = static_cast<limb_t>(rem / d);
+        rem %= d;
+    }
+    return static_cast<limb_t>(rem);
+}
+
+limb_t limb_ops::addmul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    // four independent products per iteration keep the multiplier busy while
+    // the carry chain of the previous limb resolves
+    limb_t carry = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        double_limb_t p0 = static_cast<double_limb_t>(a[i]) * b;
+        double_limb_t p1 = static_cast<double_limb_t>(a[i + 1]) * b;
+        double_limb_t p2 = static_cast<double_limb_t>(a[i + 2]) * b;
+        double_limb_t p3 = static_cast<double_limb_t>(a[i + 3]) * b;
+        p0 += static_cast<double_limb_t>(r[i]) + carry;
+        r[i] = static_cast<limb_t>(p0);
+        p1 += static_cast<double_limb_t>(r[i + 1]) + static_cast<limb_t>(p0 >> LIMB_BITS);
+        r[i + 1] = static_cast<limb_t>(p1);
+        p2 += static_cast<double_limb_t>(r[i + 2]) + static_cast<limb_t>(p1 >> LIMB_BITS);
+        r[i + 2] = static_cast<limb_t>(p2);
+        p3 += static_cast<double_limb_t>(r[i + 3]) + static_cast<limb_t>(p2 >> LIMB_BITS);
+        r[i + 3] = static_cast<limb_t>(p3);
+        carry = static_cast<limb_t>(p3 >> LIMB_BITS);
+    }
+    for (; i < n; i++) {
+        double_limb_t p = static_cast<double_limb_t>(a[i]) * b + r[i] + carry;
+        r[i] = static_cast<limb_t>(p);
+        carry = static_cast<limb_t>(p >> LIMB_BITS);
+    }
+    return carry;
+}
+
+limb_t limb_ops::submul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t product = static_cast<double_limb_t>(a[i]) * b + borrow;
+        limb_t low = static_cast<limb_t>(product);
+        borrow = static_cast<limb_t>(product >> LIMB_BITS) + (r[i] < low);
+        r[i] -= low;
+    }
+    return borrow;
+}
+
+int limb_ops::cmp_n(limb_t const *a, limb_t const *b, size_t n) {
+    for (size_t i = n; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+limb_t limb_ops::lshift(limb_t *r, limb_t const *a, size_t n, unsigned shift) {
+    if (shift == 0) {
+        std::copy_backward(a, a + n, r + n);
+        return 0;
+    }
+    limb_t out = n > 0 ? a[n - 1] >> (LIMB_BITS - shift) : 0;
+    for (size_t i = n; i-- > 1;) {
+        r[i] = (a[i] << shift) | (a[i - 1] >> (LIMB_BITS - shift));
+    }
+    if (n > 0) {
+        r[0] = a[0] << shift;
+    }
+    return out;
+}
+
+void limb_ops::rshift(limb_t *r, limb_t const *a, size_t n, unsigned shift) {
+    if (shift == 0) {
+        std::copy(a, a + n, r);
+        return;
+    }
+    for (size_t i = 0; i + 1 < n; i++) {
+        r[i] = (a[i] >> shift) | (a[i + 1] << (LIMB_BITS - shift));
+    }
+    if (n > 0) {
+        r[n - 1] = a[n - 1] >> shift;
+    }
+}
+
+void limb_ops::mul_basecase(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m) {
+    for (size_t i = 0; i < n; i++) {
+        r[i] = 0;
+    }
+    for (size_t i = 0; i < m; i++) {
+        r[i + n] = addmul_1(r + i, a, n, b[i]);
+    }
+}
+
+void limb_ops::sqr_basecase(limb_t *r, limb_t const *a, size_t n) {
+    std::fill(r, r + 2 * n, 0);
+    for (size_t i = 0; i + 1 < n; i++) {
+        r[i + n] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    }
+    lshift(r, r, 2 * n, 1);
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t square = static_cast<double_limb_t>(a[i]) * a[i];
+        r[2 * i] = add_with_carry(r[2 * i], static_cast<limb_t>(square), carry);
+        r[2 * i + 1] = add_with_carry(r[2 * i + 1], static_cast<limb_t>(square >> LIMB_BITS), carry);
+    }
+}
+
+void limb_ops::divrem(limb_t *q, limb_t *r, limb_t const *u, size_t m, limb_t const *v, size_t n, limb_t *scratch) {
+    // normalize so the top divisor limb has its high bit set; the quotient is unchanged
+    unsigned shift = 0;
+    while (!((v[n - 1] << shift) >> (LIMB_BITS - 1))) {
+        shift++;
+    }
+    limb_t *vn = scratch, *un = scratch + n;
+    lshift(vn, v, n, shift);
+    un[m] = lshift(un, u, m, shift);
+
+    limb_t v_top = vn[n - 1], v_next = vn[n - 2];
+    for (size_t j = m - n + 1; j-- > 0;) {
+        // estimate from the top two remainder limbs, refined by the second divisor limb;
+        // afterwards it is at most one too large
+        double_limb_t top = (static_cast<double_limb_t>(un[j + n]) << LIMB_BITS) | un[j + n - 1];
+        double_limb_t q_hat = top / v_top, r_hat = top % v_top;
+        while (q_hat > LIMB_MAX || q_hat * v_next > ((r_hat << LIMB_BITS) | un[j + n - 2])) {
+            q_hat--;
+            r_hat += v_top;
+            if (r_hat > LIMB_MAX) {
+                break;
+            }
+        }
+
+        limb_t borrow = submul_1(un + j, vn, n, static_cast<limb_t>(q_hat));
+        limb_t top_limb = un[j + n];
+        un[j + n] = top_limb - borrow;
+        if (top_limb < borrow) {
+            q_hat--;
+            un[j + n] += add_n(un + j, un + j, vn, n);
+        }
+        q[j] = static_cast<limb_t>(q_hat);
+    }
+    if (r != nullptr) {
+        rshift(r, un, n, shift);
+    }
+}
+
+size_t limb_ops::karatsuba_scratch(size_t n) {
+    if (n < KARATSUBA_THRESHOLD) {
+        return 0;
+    }
+    size_t hh = n - n / 2;
+    return 2 * hh + 1 + karatsuba_scratch(hh);
+}
+
+// Splits both operands into a low half of h limbs and a high half of hh >= h limbs.
+// The half sums are kept in the (not yet used) result area, their product with its
+// carry corrections in scratch; z0 and z2 then overwrite the result area in place.
+void limb_ops::karatsuba(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t *scratch) {
+    if (n < KARATSUBA_THRESHOLD) {
+        mul_basecase(r, a, n, b, n);
+        return;
+    }
+    size_t h = n / 2, hh = n - h;
+    limb_t *a_sum = r, *b_sum = r + hh;
+    limb_t *z1 = scratch, *next_scratch = scratch + 2 * hh + 1;
+
+    for (size_t i = 0; i < hh; i++) {
+        a_sum[i] = a[h + i];
+        b_sum[i] = b[h + i];
+    }
+    limb_t a_carry = add_in_place(a_sum, hh, a, h);
+    limb_t b_carry = add_in_place(b_sum, hh, b, h);
+
+    karatsuba(z1, a_sum, b_sum, hh, next_scratch);
+    z1[2 * hh] = 0;
+    if (a_carry) {
+        add_in_place(z1 + hh, hh + 1, b_sum, hh);
+    }
+    if (b_carry) {
+        add_in_place(z1 + hh, hh + 1, a_sum, hh);
+    }
+    if (a_carry && b_carry) {
+        z1[2 * hh]++;
+    }
+
+    karatsuba(r, a, b, h, next_scratch);
+    karatsuba(r + 2 * h, a + h, b + h, hh, next_scratch);
+
+    sub_in_place(z1, 2 * hh + 1, r, 2 * h);
+    sub_in_place(z1, 2 * hh + 1, r + 2 * h, 2 * hh);
+    add_in_place(r + h, 2 * n - h, z1, 2 * hh + 1);
+}
+
+// karatsuba with b = a: (a0 + a1 B^h)^2 = a0^2 + ((a0 + a1)^2 - a0^2 - a1^2) B^h + a1^2 B^2h
+void limb_ops::karatsuba_sqr(limb_t *r, limb_t const *a, size_t n, limb_t *scratch) {
+    if (n < KARATSUBA_THRESHOLD) {
+        sqr_basecase(r, a, n);
+        return;
+    }
+    size_t h = n / 2, hh = n - h;
+    limb_t *a_sum = r;
+    limb_t *z1 = scratch, *next_scratch = scratch + 2 * hh + 1;
+
+    std::copy(a + h, a + n, a_sum);
+    limb_t a_carry = add_in_place(a_sum, hh, a, h);
+
+    // (a_sum + c B^hh)^2 = a_sum^2 + 2 c a_sum B^hh + c B^2hh for a carry c of 0 or 1
+    karatsuba_sqr(z1, a_sum, hh, next_scratch);
+    z1[2 * hh] = 0;
+    if (a_carry) {
+        add_in_place(z1 + hh, hh + 1, a_sum, hh);
+        add_in_place(z1 + hh, hh + 1, a_sum, hh);
+        z1[2 * hh]++;
+    }
+
+    karatsuba_sqr(r, a, h, next_scratch);
+    karatsuba_sqr(r + 2 * h, a + h, hh, next_scratch);
+
+    sub_in_place(z1, 2 * hh + 1, r, 2 * h);
+    sub_in_place(z1, 2 * hh + 1, r + 2 * h, 2 * hh);
+    add_in_place(r + h, 2 * n - h, z1, 2 * hh + 1);
+}
+
+limb_t limb_ops::montgomery_inverse(limb_t m0) {
+    // Newton's iteration, each step doubles the number of correct low bits
+    limb_t inv = m0;
+    for (int i = 0; i < 6; i++) {
+        inv *= 2 - m0 * inv;
+    }
+    return -inv;
+}
+
+void limb_ops::redc(limb_t *r, limb_t *t, limb_t const *m, size_t n, limb_t m_inv) {
+    // clear t one limb at a time from the bottom by adding multiples of m
+    limb_t top = 0;
+    for (size_t i = 0; i < n; i++) {
+        limb_t high = addmul_1(t + i, m, n, t[i] * m_inv);
+        t[i + n] = add_with_carry(t[i + n], high, top);
+    }
+    if (top || cmp_n(t + n, m, n) >= 0) {
+        sub_n(r, t + n, m, n);
+    } else {
+        std::copy(t + n, t + 2 * n, r);
+    }
+}
+
+size_t limb_ops::montgomery_scratch(size_t n) {
+    return 2 * n + karatsuba_scratch(n);
+}
+
+void limb_ops::montgomery_mul(limb_t *r, limb_t const *a, limb_t const *b, limb_t const *m, size_t n, limb_t m_inv,
+                              limb_t *scratch) {
+    karatsuba(scratch, a, b, n, scratch + 2 * n);
+    redc(r, scratch, m, n, m_inv);
+}
+
+void limb_ops::montgomery_sqr(limb_t *r, limb_t const *a, limb_t const *m, size_t n, limb_t m_inv, limb_t *scratch) {
+    karatsuba_sqr(scratch, a, n, scratch + 2 * n);
+    redc(r, scratch, m, n, m_inv);
+}
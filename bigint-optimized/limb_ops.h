@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "limb.h"
+
+// Operand sizes (in limbs) at which multiplication and division switch algorithms.
+// All of them can be overridden at configure time to tune for a particular machine.
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#define BIGINT_KARATSUBA_THRESHOLD 32
+#endif
+
+#ifndef BIGINT_TOOM3_THRESHOLD
+#define BIGINT_TOOM3_THRESHOLD 32768
+#endif
+
+#ifndef BIGINT_NTT_THRESHOLD
+#define BIGINT_NTT_THRESHOLD 1024
+#endif
+
+#ifndef BIGINT_BURNIKEL_ZIEGLER_THRESHOLD
+#define BIGINT_BURNIKEL_ZIEGLER_THRESHOLD 256
+#endif
+
+// Kernels over raw little-endian limb ranges. None of them allocate;
+// callers own every buffer and guarantee the sizes stated below.
+namespace limb_ops {
+    static const size_t KARATSUBA_THRESHOLD = BIGINT_KARATSUBA_THRESHOLD;
+    static const size_t TOOM3_THRESHOLD = BIGINT_TOOM3_THRESHOLD;
+    static const size_t NTT_THRESHOLD = BIGINT_NTT_THRESHOLD;
+    static const size_t BURNIKEL_ZIEGLER_THRESHOLD = BIGINT_BURNIKEL_ZIEGLER_THRESHOLD;
+
+    // r[0..n) = a[0..n) + b[0..n), returns carry
+    limb_t add_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+    // r[0..n) = a[0..n) - b[0..n), returns borrow
+    limb_t sub_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+    // r[0..n) += b[0..m), m <= n, returns carry out of r[n - 1]
+    limb_t add_in_place(limb_t *r, size_t n, limb_t const *b, size_t m);
+
+    // r[0..n) -= b[0..m), m <= n, returns borrow out of r[n - 1]
+    limb_t sub_in_place(limb_t *r, size_t n, limb_t const *b, size_t m);
+
+    // r[0..n) = a[0..n) * b, returns the high limb
+    limb_t mul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+    // q[0..n) = a[0..n) / d, returns the remainder
+    limb_t divrem_1(limb_t *q, limb_t const *a, size_t n, limb_t d);
+
+    // r[0..n) += a[0..n) * b, returns the high limb
+    limb_t addmul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+    // r[0..n) -= a[0..n) * b, returns the borrow out of r[n - 1]
+    limb_t submul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+    // sign of a[0..n) - b[0..n): -1, 0 or 1
+    int cmp_n(limb_t const *a, limb_t const *b, size_t n);
+
+    // r[0..n) = a[0..n) << shift, 0 <= shift < LIMB_BITS, returns the bits shifted out
+    limb_t lshift(limb_t *r, limb_t const *a, size_t n, unsigned shift);
+
+    // r[0..n) = a[0..n) >> shift, 0 <= shift < LIMB_BITS
+    void rshift(limb_t *r, limb_t const *a, size_t n, unsigned shift);
+
+    // r[0..n + m) = a[0..n) * b[0..m)
+    void mul_basecase(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m);
+
+    // r[0..2n) = a[0..n)^2, computing each cross product a[i] * a[j] once
+    void sqr_basecase(limb_t *r, limb_t const *a, size_t n);
+
+    // Knuth's Algorithm D for n >= 2, m >= n and v[n - 1] != 0:
+    // q[0..m - n + 1) = u / v and, unless r is null, r[0..n) = u % v.
+    // scratch must hold m + n + 1 limbs
+    void divrem(limb_t *q, limb_t *r, limb_t const *u, size_t m, limb_t const *v, size_t n, limb_t *scratch);
+
+    struct bit_and {
+        limb_t operator()(limb_t a, limb_t b) const {
+            return a & b;
+        }
+    };
+
+    struct bit_or {
+        limb_t operator()(limb_t a, limb_t b) const {
+            return a | b;
+        }
+    };
+
+    struct bit_xor {
+        limb_t operator()(limb_t a, limb_t b) const {
+            return a ^ b;
+        }
+    };
+
+    // r[0..n) = op(a[0..n), b[0..n)) for Op one of bit_and, bit_or, bit_xor
+    template<typename Op>
+    void bitwise_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+    // whether s[0..n) consists of decimal digits only
+    bool is_decimal(char const *s, size_t n);
+
+    // value of the decimal digits s[0..n), n must be small enough for the value to fit a limb
+    limb_t parse_decimal(char const *s, size_t n);
+
+    // scratch size (in limbs) needed by karatsuba for operands of length n
+    size_t karatsuba_scratch(size_t n);
+
+    // r[0..2n) = a[0..n) * b[0..n), r must not overlap a, b or scratch
+    void karatsuba(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t *scratch);
+
+    // r[0..2n) = a[0..n)^2 by three half-size squarings per level,
+    // with karatsuba_scratch(n) limbs of scratch; r must not overlap a or scratch
+    void karatsuba_sqr(limb_t *r, limb_t const *a, size_t n, limb_t *scratch);
+
+    // -m^-1 modulo the limb base, for odd m0 = m[0]
+    limb_t montgomery_inverse(limb_t m0);
+
+    // Montgomery reduction: r[0..n) = t[0..2n) * B^-n mod m for t < m * B^n, where
+    // B is the limb base and m_inv = montgomery_inverse(m[0]). t is overwritten
+    void redc(limb_t *r, limb_t *t, limb_t const *m, size_t n, limb_t m_inv);
+
+    // scratch size (in limbs) needed by montgomery_mul for moduli of length n
+    size_t montgomery_scratch(size_t n);
+
+    // r[0..n) = a[0..n) * b[0..n) * B^-n mod m for a, b < m; r may alias a or b
+    void montgomery_mul(limb_t *r, limb_t const *a, limb_t const *b, limb_t const *m, size_t n, limb_t m_inv,
+                        limb_t *scratch);
+
+    // r[0..n) = a[0..n)^2 * B^-n mod m for a < m; r may alias a
+    void montgomery_sqr(limb_t *r, limb_t const *a, limb_t const *m, size_t n, limb_t m_inv, limb_t *scratch);
+
+    // whether an n by m limb product fits into the supported transform length
+    bool ntt_fits(size_t n, size_t m);
+
+    // r[0..n + m) = a[0..n) * b[0..m) by three-prime NTT, requires ntt_fits(n, m);
+    // the transform buffers are taken from limb_memory::resource()
+    void ntt_mul(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m);
+}
@@ -0,0 +1,294 @@
+#include "modular_context.h"
+#include "limb_ops.h"
+#include "limb_memory.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+modular_context::modular_context(big_integer const &modulus)
+        : m(abs(modulus)), n(m.data.size()), m_shift(0), m_inv(0) {
+    if (modulus <= 0) {
+        throw std::runtime_error("non-positive modulus");
+    }
+    if (n >= limb_ops::BURNIKEL_ZIEGLER_THRESHOLD) {
+        while (!(m.data.back() << m_shift >> (LIMB_BITS - 1))) {
+            m_shift++;
+        }
+        m_shifted = m << m_shift;
+    }
+    if (montgomery()) {
+        m_inv = limb_ops::montgomery_inverse(m.data[0]);
+        r2.resize(n);
+        big_integer r = big_integer::divrem_dispatch(big_integer(1) << static_cast<int>(2 * n * LIMB_BITS), m).second;
+        to_limbs(r, r2.data());
+    }
+}
+
+big_integer const &modular_context::modulus() const {
+    return m;
+}
+
+big_integer modular_context::reduce(big_integer const &a) const {
+    if (a.sign) {
+        big_integer r = reduce(-a);
+        return r == 0 ? r : m - r;
+    }
+    if (a < m) {
+        return a;
+    }
+    if (n >= limb_ops::BURNIKEL_ZIEGLER_THRESHOLD && a.data.size() >= n + limb_ops::BURNIKEL_ZIEGLER_THRESHOLD) {
+        return big_integer::divrem_shifted(a, m_shifted, m_shift).second;
+    }
+    return big_integer::divrem_dispatch(a, m).second;
+}
+
+big_integer modular_context::mulmod(big_integer const &a, big_integer const &b) const {
+    if (n >= limb_ops::BURNIKEL_ZIEGLER_THRESHOLD) {
+        return reduce(big_integer::mul_dispatch(reduce(a), reduce(b)));
+    }
+    std::pmr::vector<limb_t> buffer(2 * n + scratch_size(), limb_memory::resource());
+    limb_t *x = buffer.data(), *y = x + n;
+    to_limbs(reduce(a), x);
+    to_limbs(reduce(b), y);
+    mul_limbs(x, x, y, y + n);
+    return from_limbs(x);
+}
+
+big_integer modular_context::sqrmod(big_integer const &a) const {
+    if (n >= limb_ops::BURNIKEL_ZIEGLER_THRESHOLD) {
+        big_integer r = reduce(a);
+        return reduce(big_integer::mul_dispatch(r, r));
+    }
+    std::pmr::vector<limb_t> buffer(n + scratch_size(), limb_memory::resource());
+    to_limbs(reduce(a), buffer.data());
+    sqr_limbs(buffer.data(), buffer.data(), buffer.data() + n);
+    return from_limbs(buffer.data());
+}
+
+namespace {
+    // window width for exponents of the given bit length, balancing the
+    // 2^(k - 1) precomputed odd powers against one multiplication per k bits
+    size_t sliding_window(size_t bits) {
+        static const size_t bounds[] = {7, 24, 80, 240, 672};
+        size_t k = 1;
+        while (k < 6 && bits > bounds[k - 1]) {
+            k++;
+        }
+        return k;
+    }
+}
+
+big_integer modular_context::powmod(big_integer const &base, big_integer const &exponent) const {
+    if (exponent.sign) {
+        throw std::runtime_error("negative exponent");
+    }
+    size_t bits = bit_length(exponent);
+    if (bits == 0) {
+        return reduce(1);
+    }
+    size_t k = sliding_window(bits), table_size = static_cast<size_t>(1) << (k - 1);
+    std::pmr::vector<limb_t> buffer((table_size + 2) * n + scratch_size(), limb_memory::resource());
+    limb_t *odd_powers = buffer.data(), *square = odd_powers + table_size * n, *acc = square + n;
+    limb_t *scratch = acc + n;
+
+    // base, base^3, ..., base^(2^k - 1)
+    to_residue(base, odd_powers, scratch);
+    sqr_residue(square, odd_powers, scratch);
+    for (size_t i = 1; i < table_size; i++) {
+        mul_residues(odd_powers + i * n, odd_powers + (i - 1) * n, square, scratch);
+    }
+
+    // scan from the top: zero bits are single squarings, otherwise take the
+    // longest window of at most k bits that ends in a one
+    bool started = false;
+    for (size_t i = bits; i > 0;) {
+        if (!test_bit(exponent, i - 1)) {
+            sqr_residue(acc, acc, scratch);
+            i--;
+            continue;
+        }
+        size_t low = i > k ? i - k : 0;
+        while (!test_bit(exponent, low)) {
+            low++;
+        }
+        size_t value = 0;
+        for (size_t j = i; j-- > low;) {
+            value = 2 * value + test_bit(exponent, j);
+        }
+        limb_t const *power = odd_powers + value / 2 * n;
+        if (started) {
+            for (size_t j = low; j < i; j++) {
+                sqr_residue(acc, acc, scratch);
+            }
+            mul_residues(acc, acc, power, scratch);
+        } else {
+            std::copy(power, power + n, acc);
+            started = true;
+        }
+        i = low;
+    }
+    return from_residue(acc, scratch);
+}
+
+bool modular_context::montgomery() const {
+    return m.data[0] & 1;
+}
+
+size_t modular_context::scratch_size() const {
+    // product, quotient and the larger of the multiplication and division scratch
+    return 3 * n + 1 + std::max(limb_ops::karatsuba_scratch(n), 3 * n + 1);
+}
+
+void modular_context::mul_limbs(limb_t *r, limb_t const *a, limb_t const *b, limb_t *scratch) const {
+    limb_ops::karatsuba(scratch, a, b, n, scratch + 2 * n);
+    reduce_product(r, scratch);
+}
+
+void modular_context::sqr_limbs(limb_t *r, limb_t const *a, limb_t *scratch) const {
+    limb_ops::karatsuba_sqr(scratch, a, n, scratch + 2 * n);
+    reduce_product(r, scratch);
+}
+
+void modular_context::reduce_product(limb_t *r, limb_t *scratch) const {
+    limb_t *quotient = scratch + 2 * n, *rest = quotient + n + 1;
+    if (n == 1) {
+        r[0] = limb_ops::divrem_1(quotient, scratch, 2, m.data[0]);
+    } else {
+        limb_ops::divrem(quotient, r, scratch, 2 * n, m.data.data(), n, rest);
+    }
+}
+
+void modular_context::to_residue(big_integer const &a, limb_t *out, limb_t *scratch) const {
+    to_limbs(reduce(a), out);
+    if (montgomery()) {
+        limb_ops::montgomery_mul(out, out, r2.data(), m.data.data(), n, m_inv, scratch);
+    }
+}
+
+big_integer modular_context::from_residue(limb_t const *x, limb_t *scratch) const {
+    if (!montgomery()) {
+        return from_limbs(x);
+    }
+    limb_t *t = scratch, *r = scratch + 2 * n;
+    std::copy(x, x + n, t);
+    std::fill(t + n, t + 2 * n, 0);
+    limb_ops::redc(r, t, m.data.data(), n, m_inv);
+    return from_limbs(r);
+}
+
+void modular_context::mul_residues(limb_t *r, limb_t const *a, limb_t const *b, limb_t *scratch) const {
+    if (montgomery()) {
+        limb_ops::montgomery_mul(r, a, b, m.data.data(), n, m_inv, scratch);
+    } else {
+        mul_limbs(r, a, b, scratch);
+    }
+}
+
+void modular_context::sqr_residue(limb_t *r, limb_t const *a, limb_t *scratch) const {
+    if (montgomery()) {
+        limb_ops::montgomery_sqr(r, a, m.data.data(), n, m_inv, scratch);
+    } else {
+        sqr_limbs(r, a, scratch);
+    }
+}
+
+void modular_context::to_limbs(big_integer const &a, limb_t *out) const {
+    // limbs of a past n can only be redundant zeros
+    size_t size = std::min(a.data.size(), n);
+    std::copy(a.data.data(), a.data.data() + size, out);
+    std::fill(out + size, out + n, 0);
+}
+
+big_integer modular_context::from_limbs(limb_t const *limbs) const {
+    big_integer result;
+    result.data.resize(n, 0);
+    std::copy(limbs, limbs + n, result.data.mutable_data());
+    result.shrink_to_fit();
+    return result;
+}
+
+size_t modular_context::bit_length(big_integer const &a) {
+    size_t bits = a.data.size() * LIMB_BITS;
+    while (bits > 0 && !test_bit(a, bits - 1)) {
+        bits--;
+    }
+    return bits;
+}
+
+bool modular_context::test_bit(big_integer const &a, size_t i) {
+    return i / LIMB_BITS < a.data.size() && (a.data[i / LIMB_BITS] >> (i % LIMB_BITS) & 1);
+}
+
+powmod_table::powmod_table(modular_context const &context, big_integer const &base, size_t max_exponent_bits)
+        : context(context), base(base), window(1) {
+    // about digits + 2^window multiplications per exponentiation
+    auto cost = [max_exponent_bits](size_t w) {
+        return (max_exponent_bits + w - 1) / w + (static_cast<size_t>(1) << w);
+    };
+    while (window < 16 && cost(window + 1) < cost(window)) {
+        window++;
+    }
+    digits = std::max<size_t>((max_exponent_bits + window - 1) / window, 1);
+
+    size_t n = context.n;
+    std::pmr::vector<limb_t> scratch(context.scratch_size(), limb_memory::resource());
+    powers.resize(digits * n);
+    context.to_residue(base, powers.data(), scratch.data());
+    for (size_t i = 1; i < digits; i++) {
+        limb_t *power = powers.data() + i * n;
+        context.sqr_residue(power, power - n, scratch.data());
+        for (size_t j = 1; j < window; j++) {
+            context.sqr_residue(power, power, scratch.data());
+        }
+    }
+}
+
+big_integer powmod_table::pow(big_integer const &exponent) const {
+    if (exponent < 0) {
+        throw std::runtime_error("negative exponent");
+    }
+    if (modular_context::bit_length(exponent) > window * digits) {
+        return context.powmod(base, exponent);
+    }
+    std::pmr::vector<size_t> digit(digits, 0, limb_memory::resource());
+    for (size_t i = 0; i < digits * window; i++) {
+        if (modular_context::test_bit(exponent, i)) {
+            digit[i / window] |= static_cast<size_t>(1) << (i % window);
+        }
+    }
+
+    // partial holds the product of the powers with digit >= d, result the
+    // product of partial over all d seen so far
+    size_t n = context.n;
+    std::pmr::vector<limb_t> buffer(2 * n + context.scratch_size(), limb_memory::resource());
+    limb_t *partial = buffer.data(), *result = partial + n, *scratch = result + n;
+    bool partial_one = true, result_one = true;
+    for (size_t d = (static_cast<size_t>(1) << window) - 1; d > 0; d--) {
+        for (size_t i = 0; i < digits; i++) {
+            if (digit[i] != d) {
+                continue;
+            }
+            limb_t const *power = powers.data() + i * n;
+            if (partial_one) {
+                std::copy(power, power + n, partial);
+                partial_one = false;
+            } else {
+                context.mul_residues(partial, partial, power, scratch);
+            }
+        }
+        if (partial_one) {
+            continue;
+        }
+        if (result_one) {
+            std::copy(partial, partial + n, result);
+            result_one = false;
+        } else {
+            context.mul_residues(result, result, partial, scratch);
+        }
+    }
+    return result_one ? context.reduce(1) : context.from_residue(result, scratch);
+}
+
+big_integer powmod(big_integer const &base, big_integer const &exponent, big_integer const &modulus) {
+    return modular_context(modulus).powmod(base, exponent);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+
+#include "big_integer.h"
+
+// Arithmetic modulo a fixed modulus m > 0. Residues are kept as fixed-length
+// limb arrays, products are reduced by the long division kernel on those
+// arrays, and powers of odd moduli are computed entirely in Montgomery form.
+// Moduli of BURNIKEL_ZIEGLER_THRESHOLD limbs or more reduce big_integer
+// products by recursive division instead, against a modulus that the
+// constructor normalizes and shifts once.
+struct modular_context {
+    explicit modular_context(big_integer const &modulus);
+
+    big_integer const &modulus() const;
+
+    // a mod m in [0, m)
+    big_integer reduce(big_integer const &a) const;
+
+    // One product and one reduction. A single product does not use Montgomery
+    // form even for odd m: converting in and out costs more than the division
+    // it would save, which only pays off across the chain of products in powmod
+    big_integer mulmod(big_integer const &a, big_integer const &b) const;
+    big_integer sqrmod(big_integer const &a) const;
+
+    // base^exponent mod m by sliding-window exponentiation, exponent must be non-negative
+    big_integer powmod(big_integer const &base, big_integer const &exponent) const;
+
+private:
+
+    friend struct powmod_table;
+
+    big_integer m;
+    size_t n;
+
+    // for n >= BURNIKEL_ZIEGLER_THRESHOLD: m << m_shift, with the top bit of its top limb set
+    big_integer m_shifted;
+    int m_shift;
+
+    // Montgomery constants for odd m: -m^-1 mod B and R^2 mod m, where B is
+    // the limb base and R = B^n
+    limb_t m_inv;
+    std::vector<limb_t> r2;
+
+    bool montgomery() const;
+
+    size_t scratch_size() const;
+
+    // r[0..n) = a[0..n) * b[0..n) mod m, r may alias a or b
+    void mul_limbs(limb_t *r, limb_t const *a, limb_t const *b, limb_t *scratch) const;
+    void sqr_limbs(limb_t *r, limb_t const *a, limb_t *scratch) const;
+
+    // r[0..n) = scratch[0..2n) mod m, the rest of scratch is used by the division
+    void reduce_product(limb_t *r, limb_t *scratch) const;
+
+    // Residues in working form: Montgomery form for odd m, plain otherwise.
+    // Products of working forms are again working forms
+    void to_residue(big_integer const &a, limb_t *out, limb_t *scratch) const;
+    big_integer from_residue(limb_t const *x, limb_t *scratch) const;
+    void mul_residues(limb_t *r, limb_t const *a, limb_t const *b, limb_t *scratch) const;
+    void sqr_residue(limb_t *r, limb_t const *a, limb_t *scratch) const;
+
+    // a in [0, m) as exactly n limbs, and back
+    void to_limbs(big_integer const &a, limb_t *out) const;
+    big_integer from_limbs(limb_t const *limbs) const;
+
+    // for a >= 0; bits past the top limb read as zero
+    static size_t bit_length(big_integer const &a);
+    static bool test_bit(big_integer const &a, size_t i);
+};
+
+// Powers of one base modulo a fixed modulus, precomputed so that each later
+// exponentiation needs no squarings (fixed-base windowing): with w-bit exponent
+// digits e_i, base^e is the product over d of (product of base^(2^(w*i)) with e_i >= d).
+struct powmod_table {
+    // covers exponents below 2^max_exponent_bits, larger ones fall back to powmod
+    powmod_table(modular_context const &context, big_integer const &base, size_t max_exponent_bits);
+
+    // base^exponent mod m, exponent must be non-negative
+    big_integer pow(big_integer const &exponent) const;
+
+private:
+
+    modular_context context;
+    big_integer base;
+    size_t window;
+    size_t digits;
+
+    // base^(2^(window * i)) in working form, digits entries of n limbs each
+    std::vector<limb_t> powers;
+};
+
+// base^exponent mod modulus, exponent must be non-negative and modulus positive
+big_integer powmod(big_integer const &base, big_integer const &exponent, big_integer const &modulus);
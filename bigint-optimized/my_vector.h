@@ -2,60 +2,297 @@
 
 #include <iostream>
 #include <cstdio>
-#include <vector>
+#include <algorithm>
 #include <array>
-#include <memory>
-#include <variant>
+#include <atomic>
+#include <cassert>
+#include <new>
+#include <stdexcept>
 
-class my_vector {
+#include "limb.h"
+#include "limb_memory.h"
+
+// Limbs stored inline before the first heap allocation. The default keeps
+// 512-bit values, their sign-extension limb and one limb of carry inline.
+#ifndef BIGINT_INLINE_LIMBS
+#define BIGINT_INLINE_LIMBS (512 / BIGINT_LIMB_BITS + 2)
+#endif
+
+// Limb vector with InlineLimbs limbs of inline storage. The header is packed
+// into one word after the storage, and objects that embed the vector as a
+// [[no_unique_address]] member can place small fields in its tail padding.
+template<size_t InlineLimbs>
+class basic_my_vector {
 public:
-    my_vector();
+    static constexpr size_t INLINE_LIMBS = InlineLimbs;
+
+    basic_my_vector();
 
-    explicit my_vector(size_t x);
+    explicit basic_my_vector(size_t x);
 
-    my_vector(const my_vector &x);
+    basic_my_vector(const basic_my_vector &x);
 
-    my_vector &operator=(const my_vector &x);
+    // takes over x's storage and leaves x empty
+    basic_my_vector(basic_my_vector &&x) noexcept;
 
-    ~my_vector();
+    basic_my_vector &operator=(const basic_my_vector &x);
 
-    void swap(my_vector &rhs);
+    basic_my_vector &operator=(basic_my_vector &&x) noexcept;
+
+    ~basic_my_vector();
+
+    void swap(basic_my_vector &rhs);
 
     size_t size() const;
 
 
     bool empty() const;
 
-    uint32_t operator[](size_t i) const;
+    limb_t operator[](size_t i) const;
+
+    limb_t &operator[](size_t i);
 
-    uint32_t &operator[](size_t i);
+    limb_t back() const;
 
-    uint32_t back() const;
+    limb_t const *data() const;
 
+    // detaches shared storage once; the pointer stays valid until the next resize
+    limb_t *mutable_data();
+
+    // limbs that fit before the next reallocation
+    size_t capacity() const;
+
+    // makes room for x limbs without changing the size
+    void reserve(size_t x);
+
+    // keeps the capacity, so shrinking and growing back does not reallocate
     void pop_back();
 
-    void resize(size_t x, uint32_t val);
+    // grows the capacity at least geometrically when x exceeds it
+    void resize(size_t x, limb_t val);
 
 private:
 
-    static constexpr size_t SMALL_SIZE = 8;
+    static_assert(InlineLimbs * sizeof(limb_t) >= sizeof(void *), "inline storage must hold a buffer pointer");
 
-    using small_array = std::array<uint32_t, SMALL_SIZE>;
-    using big_array = std::shared_ptr<std::vector<uint32_t> >;
+    // Large data lives in a single allocation: this header immediately followed
+    // by capacity limbs. Copies of a my_vector share it until one of them writes,
+    // as long as they are made while the buffer's resource is the current one.
+    struct buffer {
+        std::atomic<size_t> ref_count;
+        size_t capacity;
+        std::pmr::memory_resource *resource;
 
-    union any {
-        big_array big;
-        small_array small{};
+        limb_t *limbs() {
+            return reinterpret_cast<limb_t *>(this + 1);
+        }
+    };
 
-        any() {};
+    using small_array = std::array<limb_t, InlineLimbs>;
 
-        ~any() {};
+    union any {
+        buffer *big;
+        small_array small{};
     } storage;
 
-    size_t size_;
+    uint32_t size_;
     bool is_small;
 
-    void split();
+    // sizes are stored in 32 bits to keep the header in one word
+    static void check_size(size_t x);
+
+    static buffer *allocate(size_t capacity, std::pmr::memory_resource *resource);
+
+    static void release(buffer *buf);
+
+    void reallocate(size_t capacity);
 
-    void expand_to_big_one();
+    void unshare();
 };
+
+template<size_t N>
+typename basic_my_vector<N>::buffer *basic_my_vector<N>::allocate(size_t capacity, std::pmr::memory_resource *resource) {
+    void *raw = resource->allocate(sizeof(buffer) + capacity * sizeof(limb_t), alignof(buffer));
+    buffer *buf = static_cast<buffer *>(raw);
+    new(&buf->ref_count) std::atomic<size_t>(1);
+    buf->capacity = capacity;
+    buf->resource = resource;
+    return buf;
+}
+
+template<size_t N>
+void basic_my_vector<N>::release(buffer *buf) {
+    if (buf->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        buf->ref_count.~atomic();
+        buf->resource->deallocate(buf, sizeof(buffer) + buf->capacity * sizeof(limb_t), alignof(buffer));
+    }
+}
+
+template<size_t N>
+void basic_my_vector<N>::reallocate(size_t capacity) {
+    assert(capacity >= size_);
+    // an existing buffer keeps its resource, so a value never moves into a
+    // scope's arena just because it grew or was unshared there
+    buffer *buf = allocate(capacity, is_small ? limb_memory::resource() : storage.big->resource);
+    std::copy(data(), data() + size_, buf->limbs());
+    if (!is_small) {
+        release(storage.big);
+    }
+    storage.big = buf;
+    is_small = false;
+}
+
+template<size_t N>
+void basic_my_vector<N>::unshare() {
+    assert(!is_small);
+    if (storage.big->ref_count.load(std::memory_order_acquire) != 1) {
+        reallocate(storage.big->capacity);
+    }
+}
+
+template<size_t N>
+basic_my_vector<N>::basic_my_vector() : size_(0), is_small(true) {}
+
+template<size_t N>
+void basic_my_vector<N>::check_size(size_t x) {
+    if (x > UINT32_MAX) {
+        throw std::runtime_error("my_vector too large");
+    }
+}
+
+template<size_t N>
+basic_my_vector<N>::basic_my_vector(size_t x) : basic_my_vector() {
+    check_size(x);
+    if (x > N) {
+        storage.big = allocate(x, limb_memory::resource());
+        std::fill(storage.big->limbs(), storage.big->limbs() + x, 0);
+        is_small = false;
+    }
+    size_ = static_cast<uint32_t>(x);
+}
+
+template<size_t N>
+basic_my_vector<N>::~basic_my_vector() {
+    if (!is_small) {
+        release(storage.big);
+    }
+}
+
+template<size_t N>
+basic_my_vector<N>::basic_my_vector(const basic_my_vector &x) : storage(x.storage), size_(x.size_), is_small(x.is_small) {
+    if (is_small) {
+        return;
+    }
+    if (storage.big->resource->is_equal(*limb_memory::resource())) {
+        storage.big->ref_count.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // do not extend the lifetime of another resource's memory, an arena may be reset under us
+        storage.big = allocate(x.storage.big->capacity, limb_memory::resource());
+        std::copy(x.data(), x.data() + size_, storage.big->limbs());
+    }
+}
+
+template<size_t N>
+basic_my_vector<N>::basic_my_vector(basic_my_vector &&x) noexcept : storage(x.storage), size_(x.size_), is_small(x.is_small) {
+    x.size_ = 0;
+    x.is_small = true;
+}
+
+template<size_t N>
+basic_my_vector<N> &basic_my_vector<N>::operator=(const basic_my_vector &x) {
+    basic_my_vector copy(x);
+    swap(copy);
+    return (*this);
+}
+
+template<size_t N>
+basic_my_vector<N> &basic_my_vector<N>::operator=(basic_my_vector &&x) noexcept {
+    basic_my_vector moved(std::move(x));
+    swap(moved);
+    return (*this);
+}
+
+template<size_t N>
+void basic_my_vector<N>::swap(basic_my_vector &rhs) {
+    std::swap(storage, rhs.storage);
+    std::swap(size_, rhs.size_);
+    std::swap(is_small, rhs.is_small);
+}
+
+template<size_t N>
+size_t basic_my_vector<N>::size() const {
+    return size_;
+}
+
+template<size_t N>
+limb_t basic_my_vector<N>::operator[](const size_t i) const {
+    return is_small ? storage.small[i] : storage.big->limbs()[i];
+}
+
+template<size_t N>
+limb_t &basic_my_vector<N>::operator[](size_t i) {
+    if (is_small) {
+        return storage.small[i];
+    }
+    unshare();
+    return storage.big->limbs()[i];
+}
+
+template<size_t N>
+limb_t basic_my_vector<N>::back() const {
+    return (*this)[size_ - 1];
+}
+
+template<size_t N>
+limb_t const *basic_my_vector<N>::data() const {
+    return is_small ? storage.small.data() : storage.big->limbs();
+}
+
+template<size_t N>
+limb_t *basic_my_vector<N>::mutable_data() {
+    if (is_small) {
+        return storage.small.data();
+    }
+    unshare();
+    return storage.big->limbs();
+}
+
+template<size_t N>
+bool basic_my_vector<N>::empty() const {
+    return size_ == 0;
+}
+
+template<size_t N>
+size_t basic_my_vector<N>::capacity() const {
+    return is_small ? N : storage.big->capacity;
+}
+
+template<size_t N>
+void basic_my_vector<N>::reserve(size_t x) {
+    check_size(x);
+    if (x > capacity()) {
+        reallocate(x);
+    }
+}
+
+template<size_t N>
+void basic_my_vector<N>::pop_back() {
+    size_--;
+}
+
+template<size_t N>
+void basic_my_vector<N>::resize(const size_t x, const limb_t val) {
+    check_size(x);
+    if (x > capacity()) {
+        reallocate(std::max(x, 2 * capacity()));
+    } else if (!is_small && x > size_) {
+        unshare();
+    }
+    if (x > size_) {
+        limb_t *limbs = is_small ? storage.small.data() : storage.big->limbs();
+        std::fill(limbs + size_, limbs + x, val);
+    }
+    size_ = static_cast<uint32_t>(x);
+}
+
+using my_vector = basic_my_vector<BIGINT_INLINE_LIMBS>;
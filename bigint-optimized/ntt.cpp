@@ -0,0 +1,206 @@
+#include "limb_ops.h"
+#include "limb_memory.h"
+
+#include <vector>
+
+// Multiplication by number-theoretic transforms modulo three NTT-friendly primes.
+// Limbs are convolved as 32-bit digits whatever the limb width. A coefficient is
+// below min(n, m) * 2^64 digits, and for every length the transforms support that
+// stays below p1 * p2 * p3 (about 2^86), so the exact coefficients are recovered
+// by the Chinese remainder theorem.
+namespace {
+    const uint32_t BIT_DEPTH = 32;
+    const size_t MAX_LOG_LENGTH = 23;
+    const size_t DIGITS_PER_LIMB = LIMB_BITS / BIT_DEPTH;
+
+    __extension__ using uint128_t = unsigned __int128;
+
+    // transform buffers come from the calling thread's limb resource
+    using digit_vector = std::pmr::vector<uint32_t>;
+
+    constexpr uint32_t pow_mod(uint64_t base, uint64_t exp, uint32_t mod) {
+        uint64_t result = 1;
+        base %= mod;
+        while (exp > 0) {
+            if (exp & 1) {
+                result = result * base % mod;
+            }
+            base = base * base % mod;
+            exp >>= 1;
+        }
+        return static_cast<uint32_t>(result);
+    }
+
+    // arithmetic modulo P < 2^30 kept in Montgomery form with R = 2^32
+    template<uint32_t P, uint32_t G>
+    struct ntt_prime {
+        static constexpr uint32_t MOD = P;
+
+        static constexpr uint32_t neg_inverse() {
+            uint32_t inv = P;
+            for (int i = 0; i < 5; i++) {
+                inv *= 2 - P * inv;
+            }
+            return -inv;
+        }
+
+        static constexpr uint32_t NEG_INV = neg_inverse();
+        static constexpr uint32_t R2 = static_cast<uint32_t>((static_cast<uint128_t>(1) << 64) % P);
+
+        static uint32_t reduce(uint64_t t) {
+            uint32_t m = static_cast<uint32_t>(t) * NEG_INV;
+            uint32_t r = static_cast<uint32_t>((t + static_cast<uint64_t>(m) * P) >> BIT_DEPTH);
+            return r >= P ? r - P : r;
+        }
+
+        static uint32_t mul(uint32_t a, uint32_t b) {
+            return reduce(static_cast<uint64_t>(a) * b);
+        }
+
+        static uint32_t to_mont(uint32_t a) {
+            return mul(a % P, R2);
+        }
+
+        static uint32_t from_mont(uint32_t a) {
+            return reduce(a);
+        }
+
+        static uint32_t add(uint32_t a, uint32_t b) {
+            uint32_t r = a + b;
+            return r >= P ? r - P : r;
+        }
+
+        static uint32_t sub(uint32_t a, uint32_t b) {
+            return a >= b ? a - b : a + P - b;
+        }
+
+        static void transform(digit_vector &a, bool inverse) {
+            size_t length = a.size();
+            for (size_t i = 1, j = 0; i < length; i++) {
+                size_t bit = length >> 1;
+                for (; j & bit; bit >>= 1) {
+                    j ^= bit;
+                }
+                j ^= bit;
+                if (i < j) {
+                    std::swap(a[i], a[j]);
+                }
+            }
+            digit_vector roots(length / 2, limb_memory::resource());
+            for (size_t len = 2; len <= length; len <<= 1) {
+                uint32_t root = pow_mod(G, (P - 1) / len, P);
+                if (inverse) {
+                    root = pow_mod(root, P - 2, P);
+                }
+                size_t half = len / 2;
+                roots[0] = to_mont(1);
+                uint32_t step = to_mont(root);
+                for (size_t j = 1; j < half; j++) {
+                    roots[j] = mul(roots[j - 1], step);
+                }
+                for (size_t i = 0; i < length; i += len) {
+                    for (size_t j = 0; j < half; j++) {
+                        uint32_t u = a[i + j];
+                        uint32_t v = mul(a[i + j + half], roots[j]);
+                        a[i + j] = add(u, v);
+                        a[i + j + half] = sub(u, v);
+                    }
+                }
+            }
+            if (inverse) {
+                uint32_t length_inv = to_mont(pow_mod(length % P, P - 2, P));
+                for (uint32_t &x : a) {
+                    x = mul(x, length_inv);
+                }
+            }
+        }
+
+        // cyclic convolution of a and b modulo P, returned in normal form
+        static digit_vector convolve(uint32_t const *a, size_t n, uint32_t const *b, size_t m, size_t length) {
+            digit_vector fa(length, 0, limb_memory::resource());
+            for (size_t i = 0; i < n; i++) {
+                fa[i] = to_mont(a[i]);
+            }
+            transform(fa, false);
+            if (a == b && n == m) {
+                for (uint32_t &x : fa) {
+                    x = mul(x, x);
+                }
+            } else {
+                digit_vector fb(length, 0, limb_memory::resource());
+                for (size_t i = 0; i < m; i++) {
+                    fb[i] = to_mont(b[i]);
+                }
+                transform(fb, false);
+                for (size_t i = 0; i < length; i++) {
+                    fa[i] = mul(fa[i], fb[i]);
+                }
+            }
+            transform(fa, true);
+            for (uint32_t &x : fa) {
+                x = from_mont(x);
+            }
+            return fa;
+        }
+    };
+
+    using prime_1 = ntt_prime<998244353, 3>;
+    using prime_2 = ntt_prime<167772161, 3>;
+    using prime_3 = ntt_prime<469762049, 3>;
+
+    size_t transform_length(size_t n, size_t m) {
+        size_t length = 1;
+        while (length < n + m - 1) {
+            length <<= 1;
+        }
+        return length;
+    }
+
+    digit_vector to_digits(limb_t const *a, size_t n) {
+        digit_vector digits(n * DIGITS_PER_LIMB, limb_memory::resource());
+        for (size_t i = 0; i < digits.size(); i++) {
+            digits[i] = static_cast<uint32_t>(a[i / DIGITS_PER_LIMB] >> (BIT_DEPTH * (i % DIGITS_PER_LIMB)));
+        }
+        return digits;
+    }
+}
+
+bool limb_ops::ntt_fits(size_t n, size_t m) {
+    return (n + m) * DIGITS_PER_LIMB - 1 <= (static_cast<size_t>(1) << MAX_LOG_LENGTH);
+}
+
+void limb_ops::ntt_mul(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m) {
+    digit_vector a_digits = to_digits(a, n);
+    digit_vector b_digits = a == b && n == m ? digit_vector(limb_memory::resource()) : to_digits(b, m);
+    uint32_t const *da = a_digits.data(), *db = b_digits.empty() ? da : b_digits.data();
+    n *= DIGITS_PER_LIMB;
+    m *= DIGITS_PER_LIMB;
+
+    size_t length = transform_length(n, m);
+    digit_vector c1 = prime_1::convolve(da, n, db, m, length);
+    digit_vector c2 = prime_2::convolve(da, n, db, m, length);
+    digit_vector c3 = prime_3::convolve(da, n, db, m, length);
+
+    // Garner's reconstruction: c = c1 + p1 * t2 + p1 * p2 * t3
+    const uint64_t p1 = prime_1::MOD, p2 = prime_2::MOD, p3 = prime_3::MOD;
+    const uint32_t p1_inv_mod_p2 = pow_mod(p1, p2 - 2, p2);
+    const uint32_t p1p2_inv_mod_p3 = pow_mod(p1 * p2 % p3, p3 - 2, p3);
+
+    uint128_t carry = 0;
+    for (size_t i = 0; i < n + m; i++) {
+        if (i < n + m - 1) {
+            uint64_t t2 = (c2[i] + p2 - c1[i] % p2) % p2 * p1_inv_mod_p2 % p2;
+            uint64_t low = c1[i] + p1 * t2;
+            uint64_t t3 = (c3[i] + p3 - low % p3) % p3 * p1p2_inv_mod_p3 % p3;
+            carry += low;
+            carry += static_cast<uint128_t>(p1 * p2) * t3;
+        }
+        limb_t digit = static_cast<uint32_t>(carry);
+        if (i % DIGITS_PER_LIMB == 0) {
+            r[i / DIGITS_PER_LIMB] = digit;
+        } else {
+            r[i / DIGITS_PER_LIMB] |= digit << (BIT_DEPTH * (i % DIGITS_PER_LIMB));
+        }
+        carry >>= BIT_DEPTH;
+    }
+}